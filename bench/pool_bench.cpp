@@ -0,0 +1,105 @@
+/**
+ * @file pool_bench.cpp
+ * @brief ThreadPool 与 WorkStealingPool 的任务提交/执行吞吐对比
+ *
+ * 模拟 cache_processor 的负载形态：单个分发线程持续提交小任务（每个任务携带一批数据），
+ * 分别测量 1..N 个工作线程下每秒完成的任务数。
+ *
+ * 用法：pool_bench [最大线程数] [每轮任务数]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.h"
+#include "WorkStealingPool.h"
+
+namespace {
+
+// 模拟一次小批量处理：对批数据做少量计算
+void do_work(const std::vector<uint32_t>& batch, std::atomic<uint64_t>& sink) {
+    uint64_t h = 1469598103934665603ULL;
+    for (uint32_t v : batch) {
+        h = (h ^ v) * 1099511628211ULL;
+    }
+    sink.fetch_add(h & 1, std::memory_order_relaxed);
+}
+
+// 等待所有任务完成
+void wait_done(const std::atomic<size_t>& done, size_t expected) {
+    while (done.load(std::memory_order_acquire) < expected) {
+        std::this_thread::yield();
+    }
+}
+
+double run_thread_pool(size_t threads, size_t tasks, const std::vector<uint32_t>& payload,
+                       std::atomic<uint64_t>& sink) {
+    std::atomic<size_t> done{0};
+    ThreadPool pool(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < tasks; ++i) {
+        // 与改造前的 cache_processor 相同：enqueue 并丢弃返回的 future；
+        // 任务形态与 run_work_stealing 相同（批数据按值捕获一次，无参数）
+        pool.enqueue([&done, &sink, batch = payload] {
+            do_work(batch, sink);
+            done.fetch_add(1, std::memory_order_release);
+        });
+    }
+    wait_done(done, tasks);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return tasks / elapsed.count();
+}
+
+double run_work_stealing(size_t threads, size_t tasks, const std::vector<uint32_t>& payload,
+                         std::atomic<uint64_t>& sink) {
+    std::atomic<size_t> done{0};
+    WorkStealingPool pool(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < tasks; ++i) {
+        pool.submit([&done, &sink, batch = payload] {
+            do_work(batch, sink);
+            done.fetch_add(1, std::memory_order_release);
+        });
+    }
+    wait_done(done, tasks);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return tasks / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t max_threads = std::thread::hardware_concurrency();
+    size_t tasks = 200000;
+    if (argc > 1) max_threads = std::strtoul(argv[1], nullptr, 10);
+    if (argc > 2) tasks = std::strtoul(argv[2], nullptr, 10);
+    if (max_threads == 0) max_threads = 1;
+
+    std::vector<uint32_t> payload(16);
+    for (size_t i = 0; i < payload.size(); ++i) payload[i] = static_cast<uint32_t>(i * 2654435761u);
+    std::atomic<uint64_t> sink{0};
+
+    std::cout << "tasks per run: " << tasks << "\n";
+    std::cout << std::left << std::setw(10) << "threads"
+              << std::setw(20) << "ThreadPool (op/s)"
+              << std::setw(24) << "WorkStealingPool (op/s)"
+              << "speedup\n";
+
+    for (size_t threads = 1; threads <= max_threads; ++threads) {
+        double base = run_thread_pool(threads, tasks, payload, sink);
+        double ws = run_work_stealing(threads, tasks, payload, sink);
+        std::cout << std::left << std::setw(10) << threads
+                  << std::setw(20) << static_cast<uint64_t>(base)
+                  << std::setw(24) << static_cast<uint64_t>(ws)
+                  << std::fixed << std::setprecision(2) << ws / base << "x\n";
+    }
+
+    return sink.load() == 0xFFFFFFFFFFFFFFFFULL;  // 防止编译器优化掉计算
+}
@@ -0,0 +1,116 @@
+#!/bin/bash
+# 判定服务器（/hello）压测：以大批次域名驱动上报接口，测量请求吞吐与延迟。
+#
+# 用法：bench/verdict_bench.sh [批次域名数] [持续秒数] [并发连接数] [名单规则数]
+#
+#   名单规则数 > 0 时会覆盖服务器正在使用的名单：先随机生成该数量的规则写入 WHITELIST 指向的文件
+#   （必须显式指定，即 dns_parse.conf 中 init_by_lua 加载的文件，原文件备份为 .bak），调用 /reload
+#   并记录加载耗时；脚本退出（包括 Ctrl-C 中断）时恢复原名单（原本不存在则删除生成的文件）并再次 /reload。
+#   请求中约一半域名命中名单。
+#
+# 环境变量：
+#   URL        判定服务器地址（默认 http://127.0.0.1:8080）
+#   WHITELIST  名单文件路径：名单规则数 > 0 时必填；否则只用于从中挑选命中域名（可不设）
+#
+# 安装了 wrk 时用 wrk 压测，否则退化为 curl 串行请求（只能反映单连接延迟）。
+
+BATCH=${1:-1000}
+DURATION=${2:-30}
+CONNECTIONS=${3:-16}
+PATTERNS=${4:-0}
+URL=${URL:-http://127.0.0.1:8080}
+WHITELIST=${WHITELIST:-}
+
+if [ "$PATTERNS" -gt 0 ] && [ -z "$WHITELIST" ]; then
+    echo "WHITELIST must name the server's whitelist file when generating patterns" >&2
+    exit 1
+fi
+if [ "$PATTERNS" -gt 0 ] && [ -e "$WHITELIST.bak" ]; then
+    echo "$WHITELIST.bak already exists (left by an earlier run?), restore it first" >&2
+    exit 1
+fi
+
+WORK_DIR=$(mktemp -d)
+REPLACED=0   # 是否已覆盖名单文件
+HAD_LIST=0   # 覆盖前名单文件是否存在（不存在时退出时删除生成的文件，而不是恢复）
+
+# 退出（含中断）时恢复原名单（原本不存在则删除）并通知服务器重新加载，再清理临时目录
+cleanup() {
+    if [ "$REPLACED" -eq 1 ]; then
+        if [ "$HAD_LIST" -eq 1 ]; then
+            mv "$WHITELIST.bak" "$WHITELIST"
+        else
+            rm -f "$WHITELIST"
+        fi
+        curl -s -o /dev/null -X POST "$URL/reload"
+        echo "whitelist restored"
+    fi
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+trap 'exit 130' INT TERM
+
+# 生成名单：一半精确规则、一半 *. 通配规则
+if [ "$PATTERNS" -gt 0 ]; then
+    if [ -f "$WHITELIST" ]; then
+        cp "$WHITELIST" "$WHITELIST.bak" || exit 1
+        HAD_LIST=1
+    fi
+    REPLACED=1
+    awk -v n="$PATTERNS" 'BEGIN {
+        srand(42);
+        for (i = 0; i < n; i++) {
+            d = sprintf("w%x-%x.com", i, int(rand() * 1e9));
+            print (i % 2 ? "*." d : d);
+        }
+    }' > "$WHITELIST"
+
+    echo "=== reload $PATTERNS patterns ==="
+    curl -s -o "$WORK_DIR/reload.json" -w "reload: %{time_total}s (HTTP %{http_code})\n" -X POST "$URL/reload"
+    cat "$WORK_DIR/reload.json"
+fi
+
+# 生成请求体：命中名单的域名（取自名单文件）与随机未命中域名各半
+awk -v batch="$BATCH" -v list="$WHITELIST" 'BEGIN {
+    srand(7);
+    n = 0;
+    while (list != "" && n < batch / 2 && (getline line < list) > 0) {
+        if (line ~ /^[[:space:]]*(#|$)/) continue;
+        sub(/^\*\./, "sub.", line);
+        domains[n++] = line;
+    }
+    while (n < batch) {
+        domains[n++] = sprintf("miss%x-%x.example.net", n, int(rand() * 1e9));
+    }
+    printf "{\"domains\":[";
+    for (i = 0; i < n; i++) printf "%s\"%s\"", (i ? "," : ""), domains[i];
+    printf "]}";
+}' > "$WORK_DIR/body.json"
+
+echo "=== batch $BATCH domains ($(wc -c < "$WORK_DIR/body.json") bytes), ${DURATION}s, $CONNECTIONS connections ==="
+
+if command -v wrk > /dev/null; then
+    cat > "$WORK_DIR/post.lua" <<LUA
+local f = io.open("$WORK_DIR/body.json", "r")
+wrk.method = "POST"
+wrk.body = f:read("*a")
+wrk.headers["Content-Type"] = "application/json"
+f:close()
+LUA
+    wrk -t "$(nproc)" -c "$CONNECTIONS" -d "${DURATION}s" --latency -s "$WORK_DIR/post.lua" "$URL/hello"
+else
+    echo "wrk not found, falling back to sequential curl"
+    END=$((SECONDS + DURATION))
+    while [ $SECONDS -lt $END ]; do
+        curl -s -o /dev/null -w "%{time_total}\n" -H "Content-Type: application/json" \
+             --data-binary "@$WORK_DIR/body.json" "$URL/hello"
+    done > "$WORK_DIR/latency.txt"
+    sort -n "$WORK_DIR/latency.txt" | awk -v batch="$BATCH" -v secs="$DURATION" '
+        { t[NR] = $1; sum += $1 }
+        END {
+            if (NR == 0) exit;
+            printf "requests: %d, %.1f req/s, %.0f domains/s\n", NR, NR / secs, NR * batch / secs;
+            printf "latency avg %.2fms, p50 %.2fms, p99 %.2fms, max %.2fms\n",
+                   sum / NR * 1000, t[int(NR * 0.5) + 1] * 1000, t[int(NR * 0.99) + 1] * 1000, t[NR] * 1000;
+        }'
+fi
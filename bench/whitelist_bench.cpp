@@ -0,0 +1,177 @@
+/**
+ * @file whitelist_bench.cpp
+ * @brief WhitelistMatcher 的构建时间、内存占用与查询吞吐（含并发重新加载）
+ *
+ * 随机生成 N 条规则（一半为 *.suffix 通配规则），测量：
+ * - 构建耗时与常驻内存增量；
+ * - 1..T 个线程的查询吞吐（命中与未命中各半）；
+ * - 查询线程运行期间反复重建并替换名单时的查询吞吐（RCU 替换不应阻塞查询）；
+ * - 与逐条规则线性匹配（判定服务器原有做法）的单次查询耗时对比。
+ *
+ * 用法：whitelist_bench [规则数] [每线程查询数] [最大线程数]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "Whitelist.h"
+
+namespace {
+
+const char* const kTlds[] = {"com", "net", "org", "cn", "io", "com.cn", "co.uk", "de"};
+
+std::string random_label(std::mt19937_64& rng) {
+    static const char kChars[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    size_t len = 4 + rng() % 12;
+    std::string label;
+    for (size_t i = 0; i < len; ++i) label.push_back(kChars[rng() % 36]);
+    return label;
+}
+
+std::string random_domain(std::mt19937_64& rng) {
+    std::string domain = random_label(rng) + "." + kTlds[rng() % 8];
+    if (rng() % 2) domain = random_label(rng) + "." + domain;
+    return domain;
+}
+
+// 常驻内存（字节）
+size_t resident_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// 原有做法：对每条规则做一次后缀比较
+bool linear_match(const std::vector<std::string>& patterns, const std::string& domain) {
+    for (const auto& pattern : patterns) {
+        if (pattern.compare(0, 2, "*.") == 0) {
+            std::string suffix = pattern.substr(2);
+            if (domain == suffix) return true;
+            if (domain.size() > suffix.size() &&
+                domain.compare(domain.size() - suffix.size() - 1, std::string::npos, "." + suffix) == 0) {
+                return true;
+            }
+        } else if (domain == pattern) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// threads 个线程各查询 lookups 次，返回总吞吐（次/秒）
+double run_lookups(const Whitelist& whitelist, const std::vector<std::string>& queries,
+                   size_t threads, size_t lookups, std::atomic<uint64_t>& sink) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            uint64_t hits = 0;
+            size_t i = t * 7919;
+            // 与 cache_processor 相同：每批取一次快照
+            for (size_t done = 0; done < lookups; done += 256) {
+                auto matcher = whitelist.snapshot();
+                for (size_t j = 0; j < 256; ++j) {
+                    hits += matcher->matches(queries[i++ % queries.size()]);
+                }
+            }
+            sink.fetch_add(hits, std::memory_order_relaxed);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return threads * lookups / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t pattern_count = 1000000;
+    size_t lookups = 2000000;
+    size_t max_threads = std::thread::hardware_concurrency();
+    if (argc > 1) pattern_count = std::strtoul(argv[1], nullptr, 10);
+    if (argc > 2) lookups = std::strtoul(argv[2], nullptr, 10);
+    if (argc > 3) max_threads = std::strtoul(argv[3], nullptr, 10);
+    if (max_threads == 0) max_threads = 1;
+
+    std::mt19937_64 rng(42);
+    std::vector<std::string> patterns;
+    std::vector<std::string> queries;
+    patterns.reserve(pattern_count);
+    for (size_t i = 0; i < pattern_count; ++i) {
+        std::string domain = random_domain(rng);
+        if (i % 2) {
+            patterns.push_back("*." + domain);
+            queries.push_back(random_label(rng) + "." + domain);  // 通配命中
+        } else {
+            patterns.push_back(domain);
+            queries.push_back(domain);                            // 精确命中
+        }
+        queries.push_back(random_domain(rng));                    // 未命中
+    }
+    std::shuffle(queries.begin(), queries.end(), rng);
+
+    size_t rss_before = resident_bytes();
+    auto start = std::chrono::steady_clock::now();
+    auto matcher = WhitelistMatcher::build(patterns);
+    std::chrono::duration<double> build_time = std::chrono::steady_clock::now() - start;
+    size_t rss_after = resident_bytes();
+
+    std::cout << "patterns: " << matcher->patterns() << ", nodes: " << matcher->nodes() << "\n"
+              << "build: " << std::fixed << std::setprecision(3) << build_time.count() << "s, "
+              << "resident +" << (rss_after - rss_before) / (1024 * 1024) << " MiB\n";
+
+    Whitelist whitelist;
+    whitelist.publish(matcher);
+    std::atomic<uint64_t> sink{0};
+
+    std::cout << "lookups per thread: " << lookups << "\n";
+    std::cout << std::left << std::setw(10) << "threads"
+              << std::setw(20) << "lookup (op/s)"
+              << "with reloads (op/s)\n";
+
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double steady = run_lookups(whitelist, queries, threads, lookups, sink);
+
+        // 查询期间在本线程反复重建并替换名单
+        std::atomic<bool> running{true};
+        size_t reloads = 0;
+        std::thread reloader([&] {
+            while (running.load()) {
+                whitelist.publish(WhitelistMatcher::build(patterns));
+                ++reloads;
+            }
+        });
+        double reloading = run_lookups(whitelist, queries, threads, lookups, sink);
+        running = false;
+        reloader.join();
+
+        std::cout << std::left << std::setw(10) << threads
+                  << std::setw(20) << static_cast<uint64_t>(steady)
+                  << static_cast<uint64_t>(reloading) << " (" << reloads << " reloads)\n";
+        if (threads == max_threads) break;
+        if (threads * 2 > max_threads) threads = max_threads / 2;
+    }
+
+    // 线性匹配：每次查询扫描全部规则，只测少量查询
+    size_t samples = 20;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; ++i) {
+        sink.fetch_add(linear_match(patterns, queries[i]), std::memory_order_relaxed);
+    }
+    std::chrono::duration<double> linear = std::chrono::steady_clock::now() - start;
+    std::cout << "linear scan: " << std::setprecision(3) << linear.count() * 1e3 / samples
+              << " ms per lookup\n";
+
+    return sink.load() == 0xFFFFFFFFFFFFFFFFULL;  // 防止编译器优化掉计算
+}
@@ -0,0 +1,336 @@
+// BoundedMPMCQueue.h
+#ifndef BOUNDED_MPMC_QUEUE_H
+#define BOUNDED_MPMC_QUEUE_H
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 缓存行大小（用于填充，避免生产者与消费者计数器伪共享）
+constexpr size_t kCacheLineSize = 64;
+
+/**
+ * @brief 队列满时的处理策略
+ */
+enum class OverflowPolicy {
+    BLOCK,        // 阻塞等待，直到有空位（不丢数据，但可能拖慢抓包线程）
+    DROP_NEWEST,  // 丢弃当前要写入的新元素
+    DROP_OLDEST   // 丢弃队首最旧的元素，为新元素腾出位置
+};
+
+/**
+ * @brief 有界无锁多生产者多消费者（MPMC）环形队列
+ *
+ * 基于每个槽位的序号（sequence）实现：生产者与消费者各自通过 CAS 推进位置计数器，
+ * 槽位序号表明该槽当前可写还是可读，入队与出队均不加锁。
+ * 容量在构造时确定（向上取整为 2 的幂），队列满时按 OverflowPolicy 处理并计数，
+ * 可在 DNS 洪泛时限制内存占用。
+ *
+ * 提供逐个与批量的入队/出队接口（push / push_bulk / try_pop / wait_and_pop / pop_bulk）。
+ * 消费者等待时先短暂自旋，之后在条件变量上休眠，直到有新元素、队列关闭或到达 deadline；
+ * 生产者只在有消费者休眠时才加锁唤醒，入队快路径仍然无锁。
+ * BLOCK 策略的生产者等待空位时采用 自旋 → 让出 CPU → 短暂休眠 的退避策略。
+ *
+ * @tparam T 元素类型，需可默认构造与移动赋值
+ */
+template <typename T>
+class BoundedMPMCQueue {
+public:
+    /**
+     * @brief 构造队列
+     *
+     * @param capacity 容量（向上取整为 2 的幂，至少为 2）
+     * @param policy 队列满时的处理策略
+     */
+    explicit BoundedMPMCQueue(size_t capacity = 65536,
+                              OverflowPolicy policy = OverflowPolicy::DROP_OLDEST) {
+        configure(capacity, policy);
+    }
+
+    BoundedMPMCQueue(const BoundedMPMCQueue&) = delete;
+    BoundedMPMCQueue& operator=(const BoundedMPMCQueue&) = delete;
+
+    /**
+     * @brief 重新设置容量与溢出策略，并清空队列
+     *
+     * 非线程安全：只能在没有任何生产者/消费者访问队列时调用（如程序启动阶段）。
+     */
+    void configure(size_t capacity, OverflowPolicy policy) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+
+        buffer_.reset(new Cell[cap]);
+        for (size_t i = 0; i < cap; ++i) {
+            buffer_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        mask_ = cap - 1;
+        policy_ = policy;
+        enqueue_pos_.store(0, std::memory_order_relaxed);
+        dequeue_pos_.store(0, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+        closed_.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 向队列尾部添加一个元素（按溢出策略处理队列满的情况）
+     *
+     * @return true 已入队；false 元素被丢弃（DROP_NEWEST）或队列已关闭
+     */
+    bool push(const T& value) {
+        T copy(value);
+        return push(std::move(copy));
+    }
+
+    bool push(T&& value) {
+        if (try_push(value)) return true;
+
+        switch (policy_) {
+            case OverflowPolicy::DROP_NEWEST:
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+
+            case OverflowPolicy::DROP_OLDEST: {
+                T discarded;
+                while (!try_push(value)) {
+                    if (try_pop(discarded)) {
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                return true;
+            }
+
+            case OverflowPolicy::BLOCK:
+            default: {
+                Backoff backoff;
+                while (!try_push(value)) {
+                    if (closed_.load(std::memory_order_acquire)) {
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+                    backoff.pause();
+                }
+                return true;
+            }
+        }
+    }
+
+    /**
+     * @brief 一次性添加一批元素，调用后 values 被清空以便复用
+     */
+    void push_bulk(std::vector<T>& values) {
+        for (auto& value : values) {
+            push(std::move(value));
+        }
+        values.clear();
+    }
+
+    /**
+     * @brief 尝试入队（非阻塞，不执行溢出策略）
+     *
+     * @return true 入队成功（value 已被移走）；false 队列已满
+     */
+    bool try_push(T& value) {
+        Cell* cell;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &buffer_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // 槽位仍被上一轮占用：队列已满
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        wake_consumer();
+        return true;
+    }
+
+    /**
+     * @brief 尝试从队列头部取出一个元素（非阻塞）
+     *
+     * @return true 取出元素成功；false 队列为空
+     */
+    bool try_pop(T& value) {
+        Cell* cell;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &buffer_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // 槽位尚未写入：队列为空
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->data);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 阻塞直到成功从队列头部取出一个元素
+     */
+    void wait_and_pop(T& value) {
+        unsigned spins = 0;
+        while (!try_pop(value)) {
+            if (spin(spins)) continue;
+            park(nullptr);
+        }
+    }
+
+    /**
+     * @brief 批量取出元素：最多 max_items 个，或等到 deadline 为止
+     *
+     * @param out 输出容器，取出的元素追加到末尾
+     * @param max_items 本次最多取出的元素个数
+     * @param deadline 最晚返回时间
+     * @return size_t 实际取出的元素个数（到达 deadline 或队列已关闭且为空时可能为 0）
+     */
+    size_t pop_bulk(std::vector<T>& out, size_t max_items,
+                    std::chrono::steady_clock::time_point deadline) {
+        size_t n = 0;
+        T value;
+        unsigned spins = 0;
+        while (n < max_items) {
+            if (try_pop(value)) {
+                out.push_back(std::move(value));
+                ++n;
+                spins = 0;
+                continue;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) break;
+            if (closed_.load(std::memory_order_acquire)) break;
+            if (spin(spins)) continue;
+            park(&deadline);
+        }
+        return n;
+    }
+
+    /**
+     * @brief 判断队列是否为空（并发场景下仅为近似值）
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief 当前元素数量（并发场景下仅为近似值）
+     */
+    size_t size() const {
+        size_t enq = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t deq = dequeue_pos_.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    /**
+     * @brief 队列容量
+     */
+    size_t capacity() const { return mask_ + 1; }
+
+    /**
+     * @brief 因队列满而被丢弃的元素总数
+     */
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 关闭队列：阻塞中的 BLOCK 策略生产者立即返回（元素计入丢弃），休眠中的 pop_bulk 取完剩余元素后返回
+     *
+     * 用于消费者退出后避免生产者永久阻塞。
+     */
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        park_cv_.notify_all();
+    }
+
+private:
+    // 消费者休眠前的自旋轮数（后一半每轮让出 CPU）
+    static constexpr unsigned kSpinsBeforePark = 128;
+
+    // 消费者空等一轮：返回 false 表示自旋已用完，应当休眠
+    static bool spin(unsigned& spins) {
+        if (spins >= kSpinsBeforePark) return false;
+        if (++spins > kSpinsBeforePark / 2) std::this_thread::yield();
+        return true;
+    }
+
+    // 队首槽位是否已写入（可读）
+    bool ready() const {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        return buffer_[pos & mask_].sequence.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    // 消费者休眠，直到队首可读、队列关闭或到达 deadline（为空时不限时）
+    void park(const std::chrono::steady_clock::time_point* deadline) {
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        sleepers_.fetch_add(1, std::memory_order_relaxed);
+        // 与 wake_consumer 中的栅栏配对：要么生产者看到休眠者并通知，要么这里看到已入队的元素
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto woken = [this] { return ready() || closed_.load(std::memory_order_acquire); };
+        if (deadline) {
+            park_cv_.wait_until(lock, *deadline, woken);
+        } else {
+            park_cv_.wait(lock, woken);
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // 入队后调用：只有存在休眠的消费者时才加锁通知
+    void wake_consumer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) == 0) return;
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        park_cv_.notify_one();
+    }
+
+    // 退避等待：先自旋，再让出 CPU，最后短暂休眠
+    struct Backoff {
+        unsigned spins = 0;
+
+        void pause() {
+            if (spins < 64) {
+                ++spins;
+            } else if (spins < 128) {
+                ++spins;
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    };
+
+    struct alignas(kCacheLineSize) Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> buffer_;
+    size_t mask_ = 0;
+    OverflowPolicy policy_ = OverflowPolicy::DROP_OLDEST;
+
+    alignas(kCacheLineSize) std::atomic<size_t> enqueue_pos_{0};   // 生产者位置
+    alignas(kCacheLineSize) std::atomic<size_t> dequeue_pos_{0};   // 消费者位置
+    alignas(kCacheLineSize) std::atomic<uint64_t> dropped_{0};     // 丢弃计数
+    std::atomic<bool> closed_{false};
+
+    alignas(kCacheLineSize) std::atomic<unsigned> sleepers_{0};    // 休眠中的消费者数
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+};
+
+#endif // BOUNDED_MPMC_QUEUE_H
@@ -5,60 +5,77 @@
 #include <atomic>
 #include <unordered_map>
 #include <chrono>
-#include "RedisDNSCache.h"
-#include "ThreadSafeQueue.h"
-#include "DomainReporter.h"
-#include "ThreadPool.h"
+#include "DomainStore.h"
+#include "pcap_capture.h"
+#include "ReportProcessor.h"
+#include "query_record.h"
+#include "DomainCoalescer.h"
+#include "Whitelist.h"
 
 /**
  * @file cache_processor.h
  * @brief 声明了 DNS 缓存处理模块的主处理函数。
  *
- * 本模块用于从域名处理队列中提取待处理域名，结合 RedisDNSCache 进行缓存判断与更新，
- * 并通过线程池异步上报指定状态的域名（如 FAKE、PEND 状态）。
+ * 本模块用于从域名处理队列中提取待处理域名，结合 DomainStore 进行缓存判断与更新，
+ * 并将新加入缓存的可疑域名写入上报队列，由独立的上报阶段（见 ReportProcessor.h）异步上报。
  *
  * 典型应用场景包括 DNS 过滤器、入侵检测系统等，适用于需要将捕获的域名进行缓存与分类上报的系统。
  */
 
 /**
- * @brief 每批触发异步上报的最小域名数量。
+ * @brief 每批从队列中取出并提交给线程池的最大记录数。
  *
- * 当聚集到的待上报域名数量 ≥ kReportThreshold 时，将提交一个异步上报任务。
+ * 一批记录只提交一个线程池任务、只加一次缓存锁，摊薄逐条处理的同步开销。
  */
-constexpr size_t kReportThreshold = 5;
+constexpr size_t kProcessBatchSize = 256;
 
 /**
- * @brief 每个域名上报失败后的最大重试次数。
+ * @brief 重复域名合并窗口。
  *
- * 若在上报过程中发生失败（如网络错误），最多重试 kMaxRetryCount 次。
+ * 窗口内同一域名的多次查询合并为一个带命中次数的事件，窗口结束后按批提交，
+ * 因此该值同时也是低流量时的最大处理延迟。
  */
-constexpr size_t kMaxRetryCount = 3;
+constexpr auto kCoalesceWindow = std::chrono::milliseconds(100);
 
 /**
- * @brief 每次重试之间的等待时间。
- *
- * 例如第一次失败后等待 kRetryDelay 时间后再次尝试。
+ * @brief 单个合并窗口内的唯一域名数上限，达到后提前结束窗口。
+ */
+constexpr size_t kCoalesceMaxEntries = 65536;
+
+/**
+ * @brief 缓存更新任务的执行方式。
  */
-constexpr auto kRetryDelay = std::chrono::seconds(5);
+enum class CacheExecutorMode {
+    SHARDED,  // 按域名哈希分片，每个分片一个线程，同一域名始终由同一线程处理，无全局锁
+    POOL      // 工作窃取线程池 + 全局缓存锁（任意线程可处理任意域名）
+};
 
 /**
  * @brief 缓存处理主线程函数。
  *
- * 持续从线程安全队列中获取域名，结合 RedisDNSCache 判断状态，并控制是否异步上报。
+ * 持续从队列中批量获取查询记录，经 DomainCoalescer 在 kCoalesceWindow 窗口内合并
+ * 重复域名后按批提交给执行器，结合 DomainStore 判断状态；新域名非阻塞地写入 report_queue。
+ * 命中本地白名单的域名直接判定为 FULL + PERMIT，不再上报。
+ * SHARDED 模式下按域名分组提交到所属分片；POOL 模式下提交到线程池并由全局锁串行化。
+ * 执行器由本函数创建，退出前会等待其中已提交的任务全部完成。
  * 适用于与抓包线程并行执行，具有一定的容错能力和退出机制。
  *
- * @param cache RedisDNSCache 实例，用于查询和更新域名状态。
- * @param domain_queue 域名输入队列，由抓包模块填充，多个线程可并发写入。
+ * @param cache DomainStore 实例，用于查询和更新域名状态。
+ * @param domain_queue 查询记录输入队列，由抓包模块填充，多个线程可并发写入；空记录为唤醒标志。
+ * @param report_queue 上报队列，新加入缓存的域名写入其中（队列满时丢弃，不阻塞缓存阶段）。
  * @param stop_processing 原子标志，若为 true 则终止处理循环。
- * @param reporter DomainReporter 实例，用于执行上报逻辑（如 HTTP POST）。
- * @param pool ThreadPool 实例，用于异步执行上报任务，避免阻塞主线程。
+ * @param mode 缓存更新任务的执行方式。
+ * @param worker_count 分片数 / 线程池线程数。
+ * @param whitelist 本地白名单，为 nullptr 时所有新域名都交给上报阶段判定。
  */
 void cache_processor(
-    RedisDNSCache& cache,
-    ThreadSafeQueue<std::string>& domain_queue,
+    DomainStore& cache,
+    DomainQueue& domain_queue,
+    ReportQueue& report_queue,
     std::atomic<bool>& stop_processing,
-    DomainReporter& reporter,
-    ThreadPool& pool
+    CacheExecutorMode mode,
+    size_t worker_count,
+    const Whitelist* whitelist
 );
 
 #endif // CACHE_PROCESSOR_H
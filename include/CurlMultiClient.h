@@ -0,0 +1,81 @@
+#ifndef CURL_MULTI_CLIENT_H
+#define CURL_MULTI_CLIENT_H
+#pragma once
+
+#include <curl/curl.h>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 同一主机的最大并发连接数（与上报阶段的并发预算 kMaxInFlightReports 相同）
+constexpr long HTTP_MAX_HOST_CONNECTIONS = 4;
+
+// 空闲 easy 句柄池的最大容量（超出的句柄直接释放）
+constexpr size_t HTTP_IDLE_HANDLES = 8;
+
+// 单个请求的超时时间（秒）
+constexpr long HTTP_TIMEOUT_SEC = 10;
+
+/**
+ * @brief 一次 HTTP 请求的结果
+ */
+struct HttpResponse {
+    CURLcode result = CURLE_OK;  // 传输结果（非 CURLE_OK 表示连接/超时等错误）
+    long status = 0;             // HTTP 状态码
+    std::string body;            // 响应内容
+};
+
+/**
+ * @brief 基于 curl multi 接口的 HTTP 客户端（单个事件循环线程，连接复用）
+ *
+ * - 调用方线程提交请求后立即得到 future，事件循环线程用 curl_multi_poll 同时推进所有请求，
+ *   多个上报批次可以同时在途；
+ * - 连接缓存属于 multi 句柄，请求结束后 TCP（及 TLS）连接保持（keep-alive）供后续请求复用，
+ *   不再为每个请求重新握手；同一主机的连接数不超过 HTTP_MAX_HOST_CONNECTIONS，多出的请求排队；
+ * - easy 句柄用完后 curl_easy_reset 放回空闲池，避免反复创建与销毁。
+ *
+ * 调用方需在构造之前完成 curl_global_init，并在 curl_global_cleanup 之前销毁本对象。
+ */
+class CurlMultiClient {
+public:
+    CurlMultiClient();
+
+    /**
+     * @brief 析构函数，等待已提交的请求完成（受 HTTP_TIMEOUT_SEC 限制）后回收事件循环线程
+     */
+    ~CurlMultiClient();
+
+    CurlMultiClient(const CurlMultiClient&) = delete;
+    CurlMultiClient& operator=(const CurlMultiClient&) = delete;
+
+    /**
+     * @brief 异步发送 POST 请求
+     * @param url 目标地址
+     * @param body 请求体（由请求持有，调用方无需保持）
+     * @param headers 请求头（由调用方持有，须在请求完成前保持有效）
+     * @return 请求结果的 future
+     */
+    std::future<HttpResponse> post(const std::string& url, std::string body,
+                                   const curl_slist* headers);
+
+private:
+    struct Transfer;
+
+    void event_loop();
+    CURL* acquire_handle();
+    void release_handle(CURL* easy);
+
+    CURLM* multi;
+    std::thread loop;
+    std::atomic<bool> stop{false};
+
+    std::mutex mutex;                                   // 保护 submitted 与 idle
+    std::vector<std::unique_ptr<Transfer>> submitted;   // 已提交、尚未加入 multi 句柄的请求
+    std::vector<CURL*> idle;                            // 空闲的 easy 句柄
+};
+
+#endif // CURL_MULTI_CLIENT_H
@@ -0,0 +1,77 @@
+#ifndef DOMAIN_COALESCER_H
+#define DOMAIN_COALESCER_H
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "query_record.h"
+
+/**
+ * @brief 合并后的查询事件：同一窗口内同一域名的多次查询折叠为一条
+ */
+struct CoalescedQuery {
+    QueryRecord record;  // 窗口内该域名最近一次的查询记录
+    uint32_t hits;       // 窗口内的查询次数
+};
+
+/**
+ * @brief 时间窗口内的重复域名合并器
+ *
+ * 绝大部分流量集中在少量热门域名上，逐条执行 Redis 更新会让 Redis 操作量随原始
+ * 查询量线性增长。合并器在一个短窗口（如 100ms）内把同一域名的重复查询折叠为
+ * 一个带命中次数的事件，下游只需对每个唯一域名执行一次更新。
+ *
+ * 非线程安全，由单个线程（cache_processor 主循环）使用。
+ */
+class DomainCoalescer {
+public:
+    /**
+     * @param window 合并窗口长度
+     * @param max_entries 窗口内唯一域名数上限，达到后提前结束窗口
+     */
+    explicit DomainCoalescer(std::chrono::milliseconds window, size_t max_entries);
+
+    /**
+     * @brief 加入一条查询记录；窗口为空时以当前时刻作为窗口起点
+     */
+    void add(const QueryRecord& record);
+
+    /**
+     * @brief 当前窗口是否应当结束（已到期或唯一域名数达到上限）
+     */
+    bool due(std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief 当前窗口的结束时刻（窗口为空时返回 now + window）
+     */
+    std::chrono::steady_clock::time_point deadline(std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief 取出窗口内所有合并后的事件并开始新窗口
+     *
+     * @param out 输出容器，事件追加到末尾
+     */
+    void flush(std::vector<CoalescedQuery>& out);
+
+    /**
+     * @brief 窗口内的唯一域名数
+     */
+    size_t size() const { return entries_.size(); }
+
+    bool empty() const { return entries_.empty(); }
+
+private:
+    std::chrono::milliseconds window_;
+    size_t max_entries_;
+    std::chrono::steady_clock::time_point window_start_;
+
+    // deque 追加元素不会使已有元素的引用失效，索引的 key 直接指向元素内的域名
+    std::deque<CoalescedQuery> entries_;
+    std::unordered_map<std::string_view, size_t> index_;
+};
+
+#endif // DOMAIN_COALESCER_H
@@ -0,0 +1,106 @@
+#ifndef DOMAIN_L1_CACHE_H
+#define DOMAIN_L1_CACHE_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DomainStore.h"
+
+// L1 缓存默认容量（条），0 表示关闭
+constexpr size_t L1_CACHE_CAPACITY = 1 << 16;
+
+// L1 缓存分片数（每个分片独立加锁）
+constexpr size_t L1_CACHE_SHARDS = 16;
+
+/**
+ * @brief 进程内分片的域名 L1 缓存（位于 Redis 之前）
+ *
+ * - 按域名哈希分为 L1_CACHE_SHARDS 个分片，每个分片一个互斥锁和一张开放寻址（线性探测）表，
+ *   负载因子不超过 0.75，删除采用后移（backward shift）而非墓碑；
+ * - 每个条目按 last_updated + ttl 判断过期，与 Redis 端的过期规则一致；
+ * - 分片满时使用 CLOCK 算法淘汰：新条目的访问位为 0，只有再次被访问的条目才能躲过一轮淘汰，
+ *   一次性出现的域名不会挤掉热点域名。
+ *
+ * 本类只负责本地存取，写穿（write-through）与失效由 RedisDNSCache 负责。
+ */
+class DomainL1Cache {
+public:
+    /**
+     * @brief 缓存的域名信息（与 Redis 哈希中的字段对应）
+     */
+    struct Value {
+        DomainStatus status;
+        DomainAction action;
+        uint32_t query_count;
+        time_t last_updated;
+        time_t last_accessed;
+        int ttl;                 // 生存时间（秒）
+    };
+
+    /**
+     * @brief 构造函数
+     * @param capacity 最大条目数，0 表示关闭 L1 缓存
+     */
+    explicit DomainL1Cache(size_t capacity = L1_CACHE_CAPACITY);
+
+    ~DomainL1Cache();
+
+    DomainL1Cache(const DomainL1Cache&) = delete;
+    DomainL1Cache& operator=(const DomainL1Cache&) = delete;
+
+    /**
+     * @brief 查找域名
+     *
+     * @param domain 域名
+     * @param now 当前时间（秒，Unix 时间戳），用于判断过期
+     * @param out 命中时写入缓存的值
+     * @return true 命中；false 未命中或已过期（过期条目会被移除）
+     */
+    bool get(std::string_view domain, time_t now, Value& out);
+
+    /**
+     * @brief 命中且未过期时累加访问次数并刷新访问/更新时间（与 Redis 端记录一次查询的效果一致）
+     *
+     * @param hits 新增访问次数
+     * @param out 命中时写入更新后的值
+     * @return true 命中；false 未命中或已过期（过期条目会被移除）
+     */
+    bool touch(std::string_view domain, time_t now, uint32_t hits, Value& out);
+
+    /**
+     * @brief 写入或覆盖域名（已过期的值不写入）
+     */
+    void put(std::string_view domain, const Value& value);
+
+    /**
+     * @brief 移除域名（Redis 端删除、淘汰或过期清理后调用，保持一致）
+     */
+    void erase(std::string_view domain);
+
+    /**
+     * @brief 是否启用（容量大于 0）
+     */
+    bool enabled() const { return capacity_ > 0; }
+
+    /**
+     * @brief 汇总各分片的统计信息
+     */
+    L1CacheStats stats() const;
+
+private:
+    struct Slot;
+    struct Shard;
+
+    Shard& shard_for(uint64_t hash) const;
+
+    size_t capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+#endif // DOMAIN_L1_CACHE_H
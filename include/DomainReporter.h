@@ -7,18 +7,25 @@
 #include <chrono>
 #include <atomic>
 #include <mutex>
+#include <memory>
+#include <future>
 #include <curl/curl.h>
-#include "RedisDNSCache.h"  // 包含 RedisDNSCache 的定义，用于访问 DNS 缓存
+#include "CurlMultiClient.h"
+#include "DomainStore.h"  // 包含 DomainStore 接口的定义，用于访问 DNS 缓存
+
+// 统计上报时单个请求包含的最大域名数（遍历缓存时按块发送，避免构造整份负载）
+constexpr size_t kStatsChunkSize = 1000;
 
 /**
- * @brief DomainReporter 是一个单例类，用于将 RedisDNSCache 中的域名信息上报到指定 HTTP 服务器。
+ * @brief DomainReporter 是一个单例类，用于将 DomainStore 中的域名信息上报到指定 HTTP 服务器。
  *
  * 功能包括：
  * - 设置上报服务器地址
  * - 执行域名上报操作
  * - 提供带重试机制的域名上报
  * 
- * 上报数据通过 HTTP POST 以 JSON 格式发送，使用 libcurl 实现。
+ * 上报数据通过 HTTP POST 以 JSON 格式发送，使用 libcurl 实现：所有请求经由同一个 CurlMultiClient，
+ * 多个调用线程的请求同时在途，并复用到判定服务器的持久连接（keep-alive），不再为每次上报重新握手。
  * 
  * 线程安全：使用 std::mutex 保护共享资源，curl 初始化仅执行一次。
  */
@@ -43,36 +50,26 @@ public:
     /**
      * @brief 向远程服务器上报指定的域名列表
      * 
-     * 该函数会将域名及其状态从 RedisDNSCache 中提取并序列化为 JSON，
+     * 该函数会将域名及其状态从 DomainStore 中提取并序列化为 JSON，
      * 然后通过 HTTP POST 请求发送到 serverUrl 指定的服务器。
      *
-     * @param cache RedisDNSCache 实例，用于获取域名状态等信息
+     * @param cache DomainStore 实例，用于获取域名状态等信息
      * @param domains 需要上报的域名列表
      * @return true 表示上报成功
      * @return false 表示上报失败
      */
-    bool reportDomains(RedisDNSCache& cache, const std::vector<std::string>& domains);
-
-    /**
-     * @brief 尝试上报域名列表，失败后重试指定次数
-     *
-     * @param cache RedisDNSCache 实例
-     * @param max_retries 最大重试次数（例如：3）
-     * @param retry_delay 每次重试之间的时间间隔（例如：std::chrono::seconds(5)）
-     */
-    void try_report_domains(
-        RedisDNSCache& cache,
-        size_t max_retries,
-        std::chrono::seconds retry_delay
-    );
+    bool reportDomains(DomainStore& cache, const std::vector<std::string>& domains);
 
     /**
      * @brief 定期上报统计信息（例如每 N 秒一次）
      *
-     * @param cache RedisDNSCache 实例
+     * 流式遍历缓存（DomainStore::forEachDomain），有访问的域名每 kStatsChunkSize 条发送一次，
+     * 发送成功后清零这些域名的访问次数；某一块发送失败时停止本轮上报。
+     *
+     * @param cache DomainStore 实例
      * @param interval_seconds 上报间隔（单位：秒）
      */
-    void reportStats(RedisDNSCache& cache, int interval_seconds);
+    void reportStats(DomainStore& cache, int interval_seconds);
 
 private:
     /**
@@ -87,34 +84,28 @@ private:
 
     std::string serverUrl;               ///< 上报服务器地址
     std::atomic<bool> curlInitialized;   ///< 标记 curl 是否初始化（线程安全）
+    std::unique_ptr<CurlMultiClient> http;  ///< 共享的 curl multi 客户端（连接复用）
+    std::once_flag curlInitOnce;         ///< 保证 curl 全局初始化只执行一次
     std::mutex urlMutex;                 ///< 用于保护 serverUrl 的读写互斥
     struct curl_slist* defaultHeaders;   ///< 默认请求头，如 Content-Type: application/json
 
     /**
-     * @brief 初始化 curl 全局资源，仅执行一次
+     * @brief 初始化 curl 全局资源与 multi 客户端，仅执行一次
      */
     void initializeCurl();
 
     /**
-     * @brief 配置并执行 curl 请求
-     * 
-     * @param curl CURL 对象
-     * @param url POST 请求目标 URL
+     * @brief 向 serverUrl 异步 POST 一段 JSON（经由共享的 multi 客户端）
+     *
      * @param json_data 发送的 JSON 字符串
-     * @param response_data 接收服务器返回的数据
+     * @return 请求结果的 future
      */
-    void configureCurl(CURL* curl, const std::string& url, const std::string& json_data, std::string& response_data);
+    std::future<HttpResponse> postJson(std::string json_data);
 
     /**
-     * @brief curl 写回调，用于获取响应内容
-     * 
-     * @param contents 返回内容指针
-     * @param size 单个数据块大小
-     * @param nmemb 数据块个数
-     * @param userp 用户自定义指针（用于累积写入）
-     * @return 实际写入的大小（size * nmemb）
+     * @brief 发送一块统计数据（HTTP POST），返回是否成功（2xx）
      */
-    static size_t writeCallback(void* contents, size_t size, size_t nmemb, void* userp);
+    bool postStats(const std::string& json_data);
 };
 
 #endif // DOMAIN_REPORTER_H
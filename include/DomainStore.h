@@ -0,0 +1,216 @@
+#ifndef DOMAIN_STORE_H
+#define DOMAIN_STORE_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 域名状态（用于标记当前域名的识别处理阶段）
+enum class DomainStatus {
+    FAKE,  // 未识别：还未上报服务器
+    PEND,  // 待判定：已上报服务器，正在分析中
+    FULL   // 完全识别：服务器已回复，状态已明确
+};
+
+// 域名动作（表示对该域名的处理策略）
+enum class DomainAction {
+    DROP,   // 拒绝访问（阻断 DNS 响应）
+    PERMIT  // 允许访问（放行 DNS 响应）
+};
+
+// 存储后端类型（命令行 --store 选择）
+enum class StoreBackend {
+    REDIS,   // Redis（RedisDNSCache）：多进程/多节点共享
+    MEMORY   // 进程内（MemoryDomainStore）：单节点部署与基准测试，无网络往返
+};
+
+/**
+ * @brief L1 缓存统计信息（只有带进程内 L1 缓存的后端填写），用于评估命中率与容量设置
+ */
+struct L1CacheStats {
+    uint64_t hits = 0;         // 命中次数
+    uint64_t misses = 0;       // 未命中次数（含过期）
+    uint64_t evictions = 0;    // 因容量不足被 CLOCK 淘汰的条目数
+    uint64_t expirations = 0;  // 查询时发现已过期而移除的条目数
+    size_t size = 0;           // 当前条目数
+    size_t capacity = 0;       // 容量上限
+};
+
+/**
+ * @brief 一条判定结果（域名状态迁移），applyVerdicts 的输入
+ */
+struct DomainVerdict {
+    std::string domain;
+    DomainStatus status;   // PEND：已上报、等待判定；FULL：服务器已给出判定
+    DomainAction action;   // status 为 PEND 时忽略（保留条目原有动作）
+    uint32_t hits = 0;     // 同时累加的访问次数（判定来自本地白名单时为合并后的查询次数）
+};
+
+/**
+ * @brief 域名存储接口：缓存处理、上报与统计模块只依赖此接口，不关心具体后端
+ *
+ * 所有实现遵循相同的语义：
+ * - 条目按状态/动作取不同 TTL（setTTLConfig），last_updated + ttl 之前有效，过期条目由 sweepExpired 批量删除；
+ * - 条目数达到容量上限时，插入新域名前按最近更新时间淘汰最旧的一批条目（LRU）；
+ * - 新插入的域名加入待上报集合，由上报线程取出后移除。
+ *
+ * 实现必须是线程安全的，各方法可由多个工作线程并发调用。
+ */
+class DomainStore {
+public:
+    /**
+     * @brief 域名缓存条目结构
+     */
+    struct DomainEntry {
+        std::string domain;          // 域名字符串
+        DomainStatus status;         // 当前状态（FAKE/PEND/FULL）
+        DomainAction action;         // 当前动作（DROP/PERMIT）
+        uint32_t query_count;        // 访问次数计数器
+        time_t last_updated;         // 状态最后更新时间
+        time_t last_accessed;        // 最后一次访问时间（用于 LRU 策略）
+    };
+
+    struct DomainMeta {
+        DomainStatus status;
+        DomainAction action;
+        uint32_t query_count;
+    };
+
+    virtual ~DomainStore() = default;
+
+    // 设置各类条目的 TTL（秒），只影响之后写入的条目
+    void setTTLConfig(int fake, int pend, int full_permit, int full_drop);
+
+    // 插入或更新：存在则更新，不存在则插入；hits 为本次合并的查询次数
+    bool insertOrUpdate(const std::string& domain, DomainStatus status, DomainAction action,
+                        uint32_t hits = 1);
+
+    // 原子地插入或更新：完成过期判断、容量淘汰、写入与加入待上报集合，
+    // 返回写入后的条目（失败返回 nullptr）；inserted 非空时写入本次是否为新插入
+    virtual std::shared_ptr<DomainEntry> upsert(const std::string& domain, DomainStatus status,
+                                                DomainAction action, uint32_t hits = 1,
+                                                bool* inserted = nullptr) = 0;
+
+    // 记录一次（合并后的）查询：已存在则保持原状态/动作并累加访问次数，不存在则按 FAKE + DROP 插入
+    virtual std::shared_ptr<DomainEntry> recordQuery(const std::string& domain, uint32_t hits = 1,
+                                                     bool* inserted = nullptr) = 0;
+
+    // 批量应用判定结果，状态只前进不后退：PEND 只作用于已存在的 FAKE 条目（保留动作，不插入），
+    // FULL 覆盖已有条目或插入新条目，并将域名移出待上报集合；写入的条目访问次数增加 verdict.hits。
+    // 整批一次提交，返回实际写入的条目数；后端不可用时抛出异常（hits 为 0 时重复应用同一批结果是安全的）
+    virtual size_t applyVerdicts(const std::vector<DomainVerdict>& verdicts) = 0;
+
+    // 查找某个域名的缓存条目（命中返回 shared_ptr，否则返回 nullptr）
+    virtual std::shared_ptr<DomainEntry> find(const std::string& domain) = 0;
+
+    // 删除某个域名条目
+    virtual bool remove(const std::string& domain) = 0;
+
+    // 获取当前缓存条目的数量
+    virtual size_t size() = 0;
+
+    // 打印所有条目信息（调试用途）
+    virtual void printAllData() = 0;
+
+    //将新插入域名添加到待上报集合
+    virtual void addToPendingReportSet(const std::string& domain) = 0;
+
+    //获取待上报域名集合中的所有域名列表
+    virtual std::vector<std::string> getPendingReportDomains() = 0;
+
+    //获取待上报域名集合的元素数量
+    virtual int getPendingReportCount() = 0;
+
+    //清空待上报域名集合
+    virtual void clearPendingReportDomains() = 0;
+
+    //从待上报域名集合中移除指定域名（不影响期间新加入的域名）
+    virtual void removePendingReportDomains(const std::vector<std::string>& domains) = 0;
+
+    // 流式遍历所有域名的简要信息，visit 返回 false 时提前结束；
+    // 遍历期间一直存在的域名至少回调一次，回调中可以调用本接口的其他方法
+    virtual void forEachDomain(
+        const std::function<bool(const std::string&, const DomainMeta&)>& visit) = 0;
+
+    // 获取所有域名的简要信息（基于 forEachDomain，会把全部条目载入内存，仅适合小规模缓存或调试）
+    std::unordered_map<std::string, DomainMeta> getAllDomainData();
+
+    // 重置某个域名的查询次数为 0（例如在成功上报后）
+    void resetQueryCount(const std::string& domain);
+
+    // 批量重置查询次数（不存在的域名忽略）
+    virtual void resetQueryCounts(const std::vector<std::string>& domains) = 0;
+
+    // 删除至多 max_batch 个已过期条目，返回删除数量
+    virtual size_t sweepExpired(size_t max_batch) = 0;
+
+    // 为没有过期索引的旧条目补建索引，cursor 初始为 "0"，返回 true 表示已完成；
+    // 默认实现：后端始终维护过期索引，无需补建
+    virtual bool backfillExpiryIndex(std::string& cursor, size_t batch);
+
+    // 写回延迟累加的访问次数，返回写回的域名数；默认实现：后端直接更新，没有待写回的数据
+    virtual size_t flushQueryCounts();
+
+    // 获取前置 L1 缓存的统计信息；默认实现：没有 L1 缓存（capacity 为 0）
+    virtual L1CacheStats l1Stats() const;
+
+    /**
+     * @brief 将状态枚举值转换为字符串（用于存储或打印）
+     */
+    static std::string statusToString(DomainStatus status);
+
+    /**
+     * @brief 将动作枚举值转换为字符串（用于存储或打印）
+     */
+    static std::string actionToString(DomainAction action);
+
+protected:
+    /**
+     * @brief TTL 配置结构体，指定不同状态下的生存时间（单位：秒）
+     */
+    struct TTLConfig {
+        int fake = 300;           // FAKE 状态的默认 TTL（5 分钟）
+        int pend = 600;           // PEND 状态的默认 TTL（10 分钟）
+        int full_permit = 86400;  // FULL+PERMIT 的默认 TTL（1 天）
+        int full_drop = 3600;     // FULL+DROP 的默认 TTL（1 小时）
+    };
+
+    /**
+     * @brief 根据条目的状态与动作类型，确定应设置的 TTL 值（秒）
+     */
+    int getTTL(DomainStatus status, DomainAction action) const;
+
+    /**
+     * @brief 容量达到上限时一次淘汰的条目数（容量的 10%，至少 2 条）
+     */
+    static size_t evictionBatch(size_t max_size);
+
+    TTLConfig ttl_config;      // 当前 TTL 设置参数
+};
+
+// ------------------ 内联辅助函数定义 ------------------
+
+inline std::string DomainStore::statusToString(DomainStatus status) {
+    switch(status) {
+        case DomainStatus::FAKE: return "FAKE";
+        case DomainStatus::PEND: return "PEND";
+        case DomainStatus::FULL: return "FULL";
+        default: return "UNKNOWN";
+    }
+}
+
+inline std::string DomainStore::actionToString(DomainAction action) {
+    switch(action) {
+        case DomainAction::DROP: return "DROP";
+        case DomainAction::PERMIT: return "PERMIT";
+        default: return "UNKNOWN";
+    }
+}
+
+#endif // DOMAIN_STORE_H
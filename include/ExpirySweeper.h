@@ -0,0 +1,45 @@
+#ifndef EXPIRY_SWEEPER_H
+#define EXPIRY_SWEEPER_H
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include "DomainStore.h"
+
+/**
+ * @brief 过期清理周期
+ */
+constexpr auto kSweepInterval = std::chrono::milliseconds(500);
+
+/**
+ * @brief 每批删除的最大过期条目数（单次 Lua 脚本的工作量上限）
+ */
+constexpr size_t kSweepBatchSize = 256;
+
+/**
+ * @brief 每个周期最多执行的批数，积压较多时分多个周期逐步清理
+ */
+constexpr size_t kSweepMaxBatchesPerTick = 16;
+
+/**
+ * @brief 过期清理线程主函数
+ *
+ * 启动后先以游标方式为没有过期索引的旧条目补建索引，之后每 kSweepInterval
+ * 按过期索引（dns:expiry）删除已到期的条目，每批至多 kSweepBatchSize 个，
+ * 使插入代价与 Redis 中的缓存规模无关，也不会长时间阻塞 Redis。
+ *
+ * @param cache DomainStore 实例
+ * @param stop_processing 线程退出标志，外部设置为 true 后线程退出
+ */
+void expiry_sweeper(
+    DomainStore& cache,
+    std::atomic<bool>& stop_processing
+);
+
+/**
+ * @brief 唤醒 expiry_sweeper 线程，使其尽快检查退出标志
+ */
+void stop_expiry_sweeper();
+
+#endif // EXPIRY_SWEEPER_H
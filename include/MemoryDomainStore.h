@@ -0,0 +1,100 @@
+#ifndef MEMORY_DOMAIN_STORE_H
+#define MEMORY_DOMAIN_STORE_H
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "DomainStore.h"
+
+// 进程内存储的最大分片数（每个分片独立加锁）
+constexpr size_t MEMORY_STORE_SHARDS = 16;
+
+// 每个分片至少容纳的条目数：容量不足 MEMORY_STORE_SHARDS 倍时减少分片数，小容量时只用一个分片
+constexpr size_t MEMORY_STORE_MIN_SHARD_ENTRIES = 4096;
+
+/**
+ * @brief 进程内的 DomainStore 实现（分片加锁），用于单节点部署与基准测试
+ *
+ * - 按域名哈希分为至多 MEMORY_STORE_SHARDS 个分片，每个分片一个互斥锁、一张哈希表、
+ *   一条按最近更新时间排列的 LRU 链表和一个按过期时间排序的过期索引；
+ * - 只有容量足够大、每个分片至少能容纳 MEMORY_STORE_MIN_SHARD_ENTRIES 条时才分片，
+ *   小容量时只有一个分片，淘汰规则与 Redis 后端的全局 LRU 完全相同；
+ *   分片时容量平均分配，分片满时淘汰该分片中最久未更新的一批条目；
+ * - TTL、upsert/recordQuery 的计数规则与待上报集合的行为与 RedisDNSCache 一致；
+ *   find 不返回已过期的条目（过期条目在查询时或由 sweepExpired 删除）。
+ *
+ * 数据只保存在本进程内，进程退出即丢失。
+ */
+class MemoryDomainStore : public DomainStore {
+public:
+    // 构造函数：指定最大缓存容量（条）
+    explicit MemoryDomainStore(size_t max_size = 10);
+    ~MemoryDomainStore() override;
+
+    MemoryDomainStore(const MemoryDomainStore&) = delete;
+    MemoryDomainStore& operator=(const MemoryDomainStore&) = delete;
+
+    std::shared_ptr<DomainEntry> upsert(const std::string& domain, DomainStatus status,
+                                        DomainAction action, uint32_t hits = 1,
+                                        bool* inserted = nullptr) override;
+
+    std::shared_ptr<DomainEntry> recordQuery(const std::string& domain, uint32_t hits = 1,
+                                             bool* inserted = nullptr) override;
+
+    size_t applyVerdicts(const std::vector<DomainVerdict>& verdicts) override;
+
+    std::shared_ptr<DomainEntry> find(const std::string& domain) override;
+
+    bool remove(const std::string& domain) override;
+
+    size_t size() override;
+
+    void printAllData() override;
+
+    void addToPendingReportSet(const std::string& domain) override;
+
+    std::vector<std::string> getPendingReportDomains() override;
+
+    int getPendingReportCount() override;
+
+    void clearPendingReportDomains() override;
+
+    void removePendingReportDomains(const std::vector<std::string>& domains) override;
+
+    // 逐个分片复制快照后在锁外回调，回调中可以修改本存储
+    void forEachDomain(
+        const std::function<bool(const std::string&, const DomainMeta&)>& visit) override;
+
+    void resetQueryCounts(const std::vector<std::string>& domains) override;
+
+    // 按各分片的过期索引删除到期条目，代价与缓存总大小无关
+    size_t sweepExpired(size_t max_batch) override;
+
+private:
+    struct Shard;
+
+    Shard& shard_for(const std::string& domain) const;
+
+    /**
+     * @brief 在分片锁内完成 过期判断 → 容量淘汰 → 写入 → 加入待上报集合（与 upsert 脚本一致）
+     */
+    std::shared_ptr<DomainEntry> runUpsert(const std::string& domain, DomainStatus status,
+                                           DomainAction action, uint32_t hits,
+                                           bool keep_existing, bool* inserted);
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t max_size;                                  // 缓存容量上限
+    std::atomic<size_t> sweep_start{0};               // 下一次清理从哪个分片开始（轮转，避免总是清理前几个分片）
+
+    std::mutex pending_mutex;                         // 保护待上报集合
+    std::unordered_set<std::string> pending_report;   // 待上报域名集合
+};
+
+#endif // MEMORY_DOMAIN_STORE_H
@@ -0,0 +1,39 @@
+#ifndef QUERY_COUNT_FLUSHER_H
+#define QUERY_COUNT_FLUSHER_H
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include "DomainStore.h"
+
+/**
+ * @brief 访问次数写回的默认刷新周期
+ *
+ * 进程崩溃时最多丢失一个刷新周期内（且不超过 WRITE_BEHIND_MAX_PENDING 个域名）的访问次数增量；
+ * 域名本身与其状态/动作在插入或更新时已同步写入 Redis，不受影响。
+ */
+constexpr auto kQueryCountFlushInterval = std::chrono::milliseconds(1000);
+
+/**
+ * @brief 访问次数写回线程主函数
+ *
+ * 每个 interval 调用一次 DomainStore::flushQueryCounts，把内存中累积的访问次数与访问时间批量写回 Redis。
+ * 待写回的域名数达到 WRITE_BEHIND_MAX_PENDING 时由写入线程立即刷新，不等待本线程。
+ *
+ * @param cache DomainStore 实例（Redis 后端需已调用 setWriteBehind(true)，其他后端为空操作）
+ * @param stop_processing 线程退出标志，外部设置为 true 后线程退出
+ * @param interval 刷新周期
+ */
+void query_count_flusher(
+    DomainStore& cache,
+    std::atomic<bool>& stop_processing,
+    std::chrono::milliseconds interval
+);
+
+/**
+ * @brief 唤醒 query_count_flusher 线程，使其尽快检查退出标志
+ */
+void stop_query_count_flusher();
+
+#endif // QUERY_COUNT_FLUSHER_H
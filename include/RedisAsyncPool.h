@@ -0,0 +1,96 @@
+// RedisAsyncPool.h
+#ifndef REDIS_ASYNC_POOL_H
+#define REDIS_ASYNC_POOL_H
+#pragma once
+
+#include <hiredis/hiredis.h>
+#include <hiredis/async.h>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 异步连接池默认连接数（所有工作线程共享）
+constexpr size_t REDIS_POOL_SIZE = 4;
+
+// 断线重连的初始间隔与上限
+constexpr auto REDIS_RECONNECT_DELAY = std::chrono::milliseconds(100);
+constexpr auto REDIS_RECONNECT_DELAY_MAX = std::chrono::seconds(5);
+
+/**
+ * @brief 拥有所有权的 Redis 回复（用 freeReplyObject 释放）
+ */
+struct RedisReplyDeleter {
+    void operator()(redisReply* reply) const { if (reply) freeReplyObject(reply); }
+};
+using RedisReplyPtr = std::unique_ptr<redisReply, RedisReplyDeleter>;
+
+/**
+ * @brief 基于 redisAsyncContext + epoll 的 Redis 异步连接池
+ *
+ * - 固定数量的连接，每个连接由一个事件循环线程（epoll + eventfd 唤醒）驱动，所有工作线程共享；
+ * - 调用方在自己的线程中把命令格式化为 RESP，投递到连接的提交队列后立即返回 future，
+ *   事件循环批量写出，同一连接上可同时有成百上千条命令在途（自动流水线），不再逐条等待往返；
+ * - 连接建立后首先发送 AUTH；断线时在途命令以错误完成，随后按指数退避自动重连，
+ *   断线期间提交的命令直接以错误完成（由调用方按原有逻辑抛出异常）。
+ *
+ * hiredis 的异步上下文不是线程安全的，因此只在所属事件循环线程中访问。
+ */
+class RedisAsyncPool {
+public:
+    /**
+     * @brief 构造函数，启动 connections 个事件循环线程（连接在线程中懒建立）
+     * @param connections 连接数量（为 0 时按 1 处理）
+     */
+    explicit RedisAsyncPool(size_t connections = REDIS_POOL_SIZE);
+
+    /**
+     * @brief 析构函数，等待已提交的命令完成后断开连接并回收线程
+     */
+    ~RedisAsyncPool();
+
+    RedisAsyncPool(const RedisAsyncPool&) = delete;
+    RedisAsyncPool& operator=(const RedisAsyncPool&) = delete;
+
+    /**
+     * @brief 异步提交命令（与 redisCommand 相同的格式化参数）
+     * @return 回复的 future；连接不可用或断线时得到空指针
+     */
+    std::future<RedisReplyPtr> commandAsync(const char* format, ...);
+    std::future<RedisReplyPtr> vcommandAsync(const char* format, va_list ap);
+
+    /**
+     * @brief 异步提交参数数组形式的命令（参数可含二进制数据）
+     */
+    std::future<RedisReplyPtr> commandArgvAsync(int argc, const char** argv, const size_t* argvlen);
+
+    /**
+     * @brief 同步执行命令：提交后等待回复（其他线程的命令在同一连接上继续流水线发送）
+     * @return 回复对象（调用方用 freeReplyObject 释放），失败返回 nullptr
+     */
+    redisReply* command(const char* format, ...);
+    redisReply* vcommand(const char* format, va_list ap);
+    redisReply* commandArgv(int argc, const char** argv, const size_t* argvlen);
+
+    /**
+     * @brief 连接数量
+     */
+    size_t size() const { return connections.size(); }
+
+private:
+    struct Request;
+    struct Connection;
+
+    std::future<RedisReplyPtr> submit(char* cmd, long long len);
+    void event_loop(Connection& conn);
+
+    std::vector<std::unique_ptr<Connection>> connections;
+    std::atomic<size_t> next{0};   // 轮询选择连接
+    std::atomic<bool> stop{false};
+};
+
+#endif // REDIS_ASYNC_POOL_H
@@ -10,6 +10,14 @@
 #include <map>
 #include <vector>
 #include <unordered_map>
+#include <utility>
+#include <atomic>
+#include <functional>
+#include <future>
+#include "DomainL1Cache.h"
+#include "DomainStore.h"
+#include "RedisAsyncPool.h"
+#include "WriteBehindBuffer.h"
 
 // Redis 连接配置
 constexpr const char* REDIS_HOST = "127.0.0.1";       // Redis 服务地址
@@ -21,128 +29,164 @@ constexpr const char* REDIS_PASSWORD = "asdfgh123-";  // Redis 认证密码（
 // 待上报域名集合 Redis Key
 constexpr const char* REDIS_PENDING_REPORT_SET = "pending_report_domains";
 
-// 域名状态（用于标记当前域名的识别处理阶段）
-enum class DomainStatus {
-    FAKE,  // 未识别：还未上报服务器
-    PEND,  // 待判定：已上报服务器，正在分析中
-    FULL   // 完全识别：服务器已回复，状态已明确
-};
+// 过期索引 Redis Key：有序集合，score 为条目的绝对过期时间（last_updated + ttl）
+constexpr const char* REDIS_EXPIRY_INDEX = "dns:expiry";
+
+// 遍历缓存时每批 ZSCAN 的 COUNT 提示（同时也是一批流水线 HMGET 的规模）
+constexpr size_t REDIS_SCAN_BATCH = 512;
 
-// 域名动作（表示对该域名的处理策略）
-enum class DomainAction {
-    DROP,   // 拒绝访问（阻断 DNS 响应）
-    PERMIT  // 允许访问（放行 DNS 响应）
+// applyVerdicts 单个脚本（一次 EVALSHA）处理的最大判定数
+constexpr size_t REDIS_VERDICT_BATCH = 512;
+
+// 条目在 Redis 中的存储编码（键名均为 dns:entries:<domain>）
+enum class EntryEncoding {
+    HASH,    // 哈希：7 个十进制字符串字段（原有格式）
+    PACKED   // 紧凑编码：17 字节定长二进制字符串，域名只保存在键名中
 };
 
 /**
  * @brief RedisDNSCache 类：用于缓存域名状态和处理信息到 Redis，并提供 TTL、LRU 控制与统计功能
+ *
+ * Redis 之前有一层进程内 L1 缓存（DomainL1Cache）：find() 命中时不访问 Redis；
+ * 所有写操作先写 Redis 再写 L1（write-through），Redis 端的删除、LRU 淘汰与过期清理同步移除 L1 条目。
+ *
+ * 所有 Redis 命令经由 RedisAsyncPool 发送：各线程共享少量异步连接，并发命令自动流水线，
+ * 不再为每个线程建立并认证一个阻塞连接。
+ *
+ * 条目编码可选哈希（默认）或紧凑二进制（EntryEncoding::PACKED）。读写路径与 Lua 脚本同时识别两种编码，
+ * 切换编码后被写入的条目自动转换，其余条目可用 migrateEntries 一次性迁移。
+ *
+ * 作为 DomainStore 的 Redis 后端，供多个进程或节点共享同一份缓存。
  */
-class RedisDNSCache {
+class RedisDNSCache : public DomainStore {
 public:
-    /**
-     * @brief 域名缓存条目结构
-     */
-    struct DomainEntry {
-        std::string domain;          // 域名字符串
-        DomainStatus status;         // 当前状态（FAKE/PEND/FULL）
-        DomainAction action;         // 当前动作（DROP/PERMIT）
-        uint32_t query_count;        // 访问次数计数器
-        time_t last_updated;         // 状态最后更新时间
-        time_t last_accessed;        // 最后一次访问时间（用于 LRU 策略）
-    };
-
-    struct DomainMeta {
-        DomainStatus status;
-        DomainAction action;
-        uint32_t query_count;
-    };
-
-    // 构造函数：可以指定最大缓存容量（默认10000条）
-    explicit RedisDNSCache(size_t max_size = 10);
+    // 构造函数：可以指定最大缓存容量（默认10000条）与 L1 缓存容量（0 表示关闭 L1）
+    explicit RedisDNSCache(size_t max_size = 10, size_t l1_capacity = L1_CACHE_CAPACITY);
 
     // 析构函数：释放 Redis 连接资源
-    ~RedisDNSCache();
+    ~RedisDNSCache() override;
 
-    // 设置各类条目的 TTL（秒）
-    void setTTLConfig(int fake, int pend, int full_permit, int full_drop);
+    // 单次往返的插入或更新：由服务端 Lua 脚本原子完成过期判断、容量淘汰、写入与加入待上报集合，
+    // 返回写入后的条目（失败返回 nullptr）；inserted 非空时写入本次是否为新插入
+    std::shared_ptr<DomainEntry> upsert(const std::string& domain, DomainStatus status,
+                                        DomainAction action, uint32_t hits = 1,
+                                        bool* inserted = nullptr) override;
 
-    // 插入一个新域名条目（若已存在则失败）
-    bool insert(const std::string& domain, DomainStatus status, DomainAction action);
+    // 记录一次（合并后的）查询：已存在则保持原状态/动作并累加访问次数，不存在则按 FAKE + DROP 插入；
+    // 与 upsert 相同，单次往返完成。开启写回后，L1 中已有的域名只在内存中累加，不访问 Redis
+    std::shared_ptr<DomainEntry> recordQuery(const std::string& domain, uint32_t hits = 1,
+                                             bool* inserted = nullptr) override;
 
-    // 更新已有条目的状态/动作（通过现有 shared_ptr 引用）
-    bool update(const std::shared_ptr<DomainEntry>& existing_entry,
-                const std::string& domain, DomainStatus status, DomainAction action);
-
-    // 插入或更新：存在则更新，不存在则插入
-    bool insertOrUpdate(const std::string& domain, DomainStatus status, DomainAction action);
+    // 批量应用判定结果：每 REDIS_VERDICT_BATCH 条一次 EVALSHA，服务端原子完成过期判断、容量淘汰与写入，
+    // 各批次流水线发送，整批只等待一次往返；写入的条目同步更新 L1。
+    // 开启写回时，L1 中已是同一 FULL 判定的条目只在内存中累加访问次数，不访问 Redis
+    size_t applyVerdicts(const std::vector<DomainVerdict>& verdicts) override;
 
     // 查找某个域名的缓存条目（命中返回 shared_ptr，否则返回 nullptr）
-    std::shared_ptr<DomainEntry> find(const std::string& domain);
+    std::shared_ptr<DomainEntry> find(const std::string& domain) override;
 
     // 删除某个域名条目（从 Redis 和本地缓存中移除）
-    bool remove(const std::string& domain);
+    bool remove(const std::string& domain) override;
 
     // 执行清理策略（LRU 淘汰或 TTL 过期清除）
     void cleanup();
 
     // 获取当前缓存条目的数量
-    size_t size();
+    size_t size() override;
 
     // 打印所有条目信息（调试用途）
-    void printAllData();
+    void printAllData() override;
 
     //将新插入域名添加到待上报集合
-    void addToPendingReportSet(const std::string& domain);
+    void addToPendingReportSet(const std::string& domain) override;
 
     //获取待上报域名集合中的所有域名列表
-    std::vector<std::string> getPendingReportDomains();
+    std::vector<std::string> getPendingReportDomains() override;
 
     //获取待上报域名集合的元素数量
-    int getPendingReportCount();
+    int getPendingReportCount() override;
 
     //清空待上报域名集合
-    void clearPendingReportDomains();
+    void clearPendingReportDomains() override;
 
-    // 获取所有域名的简要信息（供上报模块使用）
-    // 返回：unordered_map，其中 key 为域名，value 为状态、动作和查询次数
-    std::unordered_map<std::string, DomainMeta> getAllDomainData();
+    //从待上报域名集合中移除指定域名（SREM，不影响期间新加入的域名）
+    void removePendingReportDomains(const std::vector<std::string>& domains) override;
 
-    // 重置某个域名的查询次数为 0（例如在成功上报后）
-    void resetQueryCount(const std::string& domain);
+    // 流式遍历所有域名的简要信息：按游标分批（REDIS_SCAN_BATCH）ZSCAN dns:lru，每批读取命令流水线发送，逐条回调 visit；
+    // visit 返回 false 时提前结束。内存占用只与 batch 有关，不随缓存规模增长。
+    // 与 SCAN 语义一致：遍历期间一直存在的域名至少回调一次，个别域名可能重复出现
+    void forEachDomain(
+        const std::function<bool(const std::string&, const DomainMeta&)>& visit) override;
 
+    // 批量重置查询次数（命令流水线发送，整批只等待一次往返）
+    void resetQueryCounts(const std::vector<std::string>& domains) override;
 
+    // 设置新写入条目使用的编码（读取时两种编码均可识别）
+    void setEntryEncoding(EntryEncoding encoding);
 
+    // 当前写入编码
+    EntryEncoding entryEncoding() const;
 
-private:
-    /**
-     * @brief 将状态枚举值转换为字符串（用于 Redis 存储或打印）
-     */
-    static std::string statusToString(DomainStatus status);
+    // 一次性迁移：按游标遍历 dns:lru，将所有条目转换为 target 编码（每批一次 EVAL，服务端原子转换），
+    // 返回实际转换的条目数；可在服务运行期间执行
+    size_t migrateEntries(EntryEncoding target, size_t batch = REDIS_SCAN_BATCH);
 
-    /**
-     * @brief 将动作枚举值转换为字符串（用于 Redis 存储或打印）
-     */
-    static std::string actionToString(DomainAction action);
+    // 开启/关闭访问次数写回（write-behind，依赖 L1 缓存判断域名是否已存在）
+    void setWriteBehind(bool enabled);
 
-    /**
-     * @brief TTL 配置结构体，指定不同状态下的生存时间（单位：秒）
-     */
-    struct TTLConfig {
-        int fake = 300;           // FAKE 状态的默认 TTL（5 分钟）
-        int pend = 600;           // PEND 状态的默认 TTL（10 分钟）
-        int full_permit = 86400;  // FULL+PERMIT 的默认 TTL（1 天）
-        int full_drop = 3600;     // FULL+DROP 的默认 TTL（1 小时）
-    };
+    // 将写回缓冲区中的访问次数增量写入 Redis：每 WRITE_BEHIND_FLUSH_BATCH 个域名一次 EVALSHA，
+    // 各批次流水线发送；返回成功写回的域名数（失败的增量放回缓冲区，超出缓冲区容量的部分丢弃）
+    size_t flushQueryCounts() override;
+
+    // 待写回的域名数
+    size_t pendingQueryCounts() const;
+
+    // 获取 L1 缓存的命中/未命中等统计信息
+    L1CacheStats l1Stats() const override;
+
+    // 删除至多 max_batch 个已过期条目（按过期索引取出到期域名），返回删除数量
+    size_t sweepExpired(size_t max_batch) override;
 
+    // 为没有过期索引的旧条目补建索引：按游标（ZSCAN dns:lru）每次处理约 batch 个域名，
+    // cursor 初始为 "0"；返回 true 表示已扫描完毕
+    bool backfillExpiryIndex(std::string& cursor, size_t batch) override;
+
+private:
     // redisContext* redis_conn;  // hiredis Redis 连接对象
     std::mutex mtx;            // 线程安全互斥锁
     size_t max_size;           // 缓存容量上限（触发 LRU）
-    TTLConfig ttl_config;      // 当前 TTL 设置参数
+    DomainL1Cache l1;          // 进程内 L1 缓存
+    RedisAsyncPool redis;      // 共享的异步 Redis 连接池（所有线程的命令在少量连接上流水线发送）
+    std::atomic<EntryEncoding> encoding{EntryEncoding::HASH};  // 新写入条目的编码
+    WriteBehindBuffer write_behind;                // 待写回的访问次数增量
+    std::atomic<bool> write_behind_enabled{false};
+    std::mutex flush_mutex;                        // 同一时间只有一个线程执行写回
 
     /**
-     * @brief 获取或初始化 Redis 连接（懒加载）
+     * @brief 服务端 Lua 脚本：首次使用时 SCRIPT LOAD 一次，之后以 EVALSHA 调用
      */
-    redisContext* getConnection();
+    struct LuaScript {
+        explicit LuaScript(std::string source) : source(std::move(source)) {}
+        const std::string source;  // 脚本源码（自有副本，不依赖其他翻译单元中静态对象的初始化顺序）
+        std::once_flag loaded;
+        std::string sha;            // SCRIPT LOAD 返回的 SHA1
+    };
+
+    /**
+     * @brief 脚本调用参数（numkeys 及之后的部分），引用的字符串须在回复返回前保持有效
+     */
+    struct ScriptArgs {
+        std::vector<const char*> argv;
+        std::vector<size_t> argvlen;
+
+        void add(const char* arg, size_t len) { argv.push_back(arg); argvlen.push_back(len); }
+        void add(const std::string& arg) { add(arg.c_str(), arg.size()); }
+    };
+
+    LuaScript upsert_script;    // 单个域名的插入或更新
+    LuaScript verdict_script;   // 批量应用判定结果
+    LuaScript flush_script;     // 访问次数写回
+    std::atomic<long long> flush_failed_at{0};  // 最近一次写回失败的时间（steady_clock 计数，0 表示未失败）
 
     /**
      * @brief 执行 Redis 写命令（格式化参数，无需返回值）
@@ -155,38 +199,64 @@ private:
     std::string getStringResult(const char* format, ...);
 
     /**
-     * @brief 根据条目的状态与动作类型，确定应设置的 TTL 值（秒）
+     * @brief 执行 upsert 脚本（EVALSHA，脚本缓存丢失时回退为 EVAL），keep_existing 为 true 时保留已有状态/动作
      */
-    int getTTL(DomainStatus status, DomainAction action);
+    std::shared_ptr<DomainEntry> runUpsert(const std::string& domain, DomainStatus status,
+                                           DomainAction action, uint32_t hits,
+                                           bool keep_existing, bool* inserted);
 
     /**
-     * @brief 预检查并确保缓存容量足够，若超过上限则触发 LRU 淘汰
+     * @brief 获取脚本的 SHA1（首次调用时 SCRIPT LOAD，失败抛出异常，下次调用重试）
      */
-    void makeRoom();
+    const std::string& scriptSha(LuaScript& script);
 
     /**
-     * @brief 清除 Redis 中过期的域名条目（依赖 TTL 和 last_updated 时间）
+     * @brief 以 EVALSHA 异步执行脚本，回复须经 awaitScript 取得
      */
-    void cleanupExpired();
-};
+    std::future<RedisReplyPtr> evalScriptAsync(LuaScript& script, const ScriptArgs& args);
+
+    /**
+     * @brief 等待 evalScriptAsync 的回复；脚本缓存丢失（NOSCRIPT）时以 EVAL 发送源码重试一次
+     */
+    RedisReplyPtr awaitScript(LuaScript& script, const ScriptArgs& args, std::future<RedisReplyPtr>& pending);
+
+    /**
+     * @brief 发送 EVAL / EVALSHA 命令（body 为脚本源码或 SHA1）
+     */
+    std::future<RedisReplyPtr> sendScript(const char* command, const std::string& body, const ScriptArgs& args);
 
-// ------------------ 内联辅助函数定义 ------------------
-
-inline std::string RedisDNSCache::statusToString(DomainStatus status) {
-    switch(status) {
-        case DomainStatus::FAKE: return "FAKE";
-        case DomainStatus::PEND: return "PEND";
-        case DomainStatus::FULL: return "FULL";
-        default: return "UNKNOWN";
-    }
-}
-
-inline std::string RedisDNSCache::actionToString(DomainAction action) {
-    switch(action) {
-        case DomainAction::DROP: return "DROP";
-        case DomainAction::PERMIT: return "PERMIT";
-        default: return "UNKNOWN";
-    }
-}
+    /**
+     * @brief 按游标分批遍历 dns:lru 中的域名（ZSCAN），每批回调一次 on_batch；回调返回 false 时停止
+     * @return true 表示遍历完毕，false 表示被回调提前结束
+     */
+    bool scanDomains(size_t batch, const std::function<bool(const std::vector<std::string>&)>& on_batch);
+
+    /**
+     * @brief 写回缓冲区中的增量（调用方持有 flush_mutex）
+     */
+    size_t flushQueryCountsLocked();
+
+    /**
+     * @brief 大小触发的刷新是否可以执行（上次写回失败后至少间隔 WRITE_BEHIND_RETRY_DELAY）
+     */
+    bool flushRetryDue() const;
+
+    /**
+     * @brief 按指定编码异步读取条目（PACKED 为 GET，HASH 为 HGETALL）
+     */
+    std::future<RedisReplyPtr> requestEntry(const std::string& domain, EntryEncoding enc);
+
+    /**
+     * @brief 等待 requestEntry 的回复并解码；条目为另一种编码（WRONGTYPE）时改用对应命令重读
+     * @return true 表示条目存在且解码成功
+     */
+    bool loadEntry(const std::string& domain, std::future<RedisReplyPtr>& pending,
+                   DomainL1Cache::Value& out);
+
+    /**
+     * @brief 从 L1 缓存中移除 Lua 脚本返回的已删除域名列表
+     */
+    void evictFromL1(redisReply* deleted_keys);
+};
 
 #endif // REDISDNS_CACHE_H
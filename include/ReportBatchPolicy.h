@@ -0,0 +1,116 @@
+#ifndef REPORT_BATCH_POLICY_H
+#define REPORT_BATCH_POLICY_H
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @file ReportBatchPolicy.h
+ * @brief 上报批次的自适应攒批策略与逐批次统计。
+ */
+
+/**
+ * @brief 攒批上限：任一上限达到即发送。
+ */
+struct ReportBatchLimits {
+    size_t max_domains;                     // 单个批次的最大域名数
+    size_t max_bytes;                       // 单个批次的最大负载字节数（按域名长度估算）
+    std::chrono::milliseconds max_linger;   // 批次中第一个域名的最长等待时间
+};
+
+/**
+ * @brief 根据新域名到达速率自适应调整批次大小
+ *
+ * 按时间衰减的指数加权平均（时间常数 kRateWindow）估计到达速率 r，
+ * 目标批次大小取 r × max_linger（限制在 [1, max_domains] 之间），即一个 linger 窗口内预计到达的域名数：
+ * - 空闲时目标为 1，第一个未知域名立即发送，不再因攒不够阈值而一直等待；
+ * - 突发时目标随速率增长，吞吐来自大批次而不是成千上万个小请求；
+ * - 无论速率如何，批次中第一个域名的等待时间不超过 max_linger，字节数不超过 max_bytes。
+ *
+ * 只由上报主线程使用，不加锁。
+ */
+class ReportBatchPolicy {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 到达速率估计的时间常数
+    static constexpr auto kRateWindow = std::chrono::seconds(1);
+
+    explicit ReportBatchPolicy(const ReportBatchLimits& limits);
+
+    /**
+     * @brief 记录 count 个新域名在 now 时刻到达，更新速率估计
+     */
+    void on_arrival(size_t count, Clock::time_point now);
+
+    /**
+     * @brief 当前的目标批次大小
+     */
+    size_t target_size() const { return target_; }
+
+    /**
+     * @brief 当前的到达速率估计（域名/秒）
+     */
+    double arrival_rate() const { return rate_; }
+
+    /**
+     * @brief 当前积压是否应立即发送一批
+     * @param domains 积压的域名数
+     * @param bytes 积压的估算字节数
+     * @param waited 积压中第一个域名已等待的时间
+     */
+    bool should_send(size_t domains, size_t bytes, Clock::duration waited) const;
+
+    const ReportBatchLimits& limits() const { return limits_; }
+
+    /**
+     * @brief 单个域名在负载中占用的估算字节数（JSON 引号与逗号）
+     */
+    static size_t domain_bytes(const std::string& domain) { return domain.size() + 3; }
+
+private:
+    ReportBatchLimits limits_;
+    double rate_ = 0.0;                // 域名/秒
+    size_t target_ = 1;
+    Clock::time_point last_arrival_{};
+};
+
+/**
+ * @brief 逐批次统计：批次大小、第一个域名的等待时间与请求往返时间
+ *
+ * 由多个发送线程并发记录，计数器均为原子变量。
+ */
+struct ReportBatchMetrics {
+    std::atomic<uint64_t> batches{0};       // 已发送的批次数（含重试）
+    std::atomic<uint64_t> failures{0};      // 失败的批次数
+    std::atomic<uint64_t> domains{0};       // 已发送的域名总数
+    std::atomic<uint64_t> bytes{0};         // 已发送的估算字节数
+    std::atomic<uint64_t> max_size{0};      // 最大批次（域名数）
+    std::atomic<uint64_t> wait_ns{0};       // 首次发送的批次中第一个域名的等待时间总和
+    std::atomic<uint64_t> max_wait_ns{0};
+    std::atomic<uint64_t> waited_batches{0};
+    std::atomic<uint64_t> rtt_ns{0};        // 请求往返时间总和
+    std::atomic<uint64_t> max_rtt_ns{0};
+
+    /**
+     * @brief 记录一个批次
+     * @param size 域名数
+     * @param batch_bytes 估算字节数
+     * @param wait 第一个域名的等待时间（重试批次传入负值，不计入等待统计）
+     * @param rtt 请求往返时间
+     * @param ok 是否成功
+     */
+    void record(size_t size, size_t batch_bytes, std::chrono::nanoseconds wait,
+                std::chrono::nanoseconds rtt, bool ok);
+
+    /**
+     * @brief 输出一行汇总（批次数、平均/最大批次、平均/最大等待与往返时间）
+     */
+    std::string summary() const;
+};
+
+#endif // REPORT_BATCH_POLICY_H
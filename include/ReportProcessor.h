@@ -0,0 +1,95 @@
+#ifndef REPORT_PROCESSOR_H
+#define REPORT_PROCESSOR_H
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include "BoundedMPMCQueue.h"
+#include "query_record.h"
+#include "DomainStore.h"
+#include "DomainReporter.h"
+#include "ReportBatchPolicy.h"
+
+/**
+ * @file ReportProcessor.h
+ * @brief 声明独立的域名上报流水线阶段。
+ *
+ * 缓存阶段只把新加入缓存的可疑域名写入上报队列（非阻塞，队列满时丢弃），
+ * 上报阶段在自己的线程中按到达速率自适应攒批（ReportBatchPolicy），并在有限的并发预算内异步发送 HTTP 请求。
+ * 失败的批次按指数退避重新调度，等待期间不阻塞任何线程，
+ * 因此判定服务器变慢或宕机不会拖慢抓包 → 缓存路径。
+ *
+ * Redis 中的待上报集合（pending_report_domains）作为持久记录：上报成功后才从集合中移除，
+ * 因队列满、重试耗尽或程序退出而未上报的域名会在启动时及周期性重新同步时再次上报。
+ */
+
+/**
+ * @brief 缓存阶段 → 上报阶段的队列类型（元素为新域名的查询记录，空记录为唤醒标志）。
+ */
+using ReportQueue = BoundedMPMCQueue<QueryRecord>;
+
+/**
+ * @brief 上报队列默认容量（条）。
+ */
+constexpr size_t REPORT_QUEUE_CAPACITY = 1 << 14;
+
+/**
+ * @brief 单次上报请求中的最大域名数量。
+ *
+ * 目标批次大小随到达速率在 [1, kReportBatchMax] 间调整；并发预算用尽时批次继续增长，直到该上限。
+ */
+constexpr size_t kReportBatchMax = 256;
+
+/**
+ * @brief 单次上报请求的最大负载字节数（按域名长度估算）。
+ */
+constexpr size_t kReportBatchMaxBytes = 16 * 1024;
+
+/**
+ * @brief 批次中第一个域名的最长等待时间（新域名判定延迟的上界，不含退避）。
+ */
+constexpr auto kReportLinger = std::chrono::milliseconds(200);
+
+/**
+ * @brief 同时进行中的上报请求数上限（并发预算）。
+ */
+constexpr size_t kMaxInFlightReports = 4;
+
+/**
+ * @brief 单个批次的最大尝试次数，用尽后放弃该批次（域名仍保留在待上报集合中）。
+ */
+constexpr size_t kMaxRetryCount = 5;
+
+/**
+ * @brief 指数退避的初始等待时间与上限。
+ *
+ * 第 n 次失败后等待 min(kRetryDelay * 2^(n-1), kRetryDelayMax)，期间暂停发送新批次。
+ */
+constexpr auto kRetryDelay = std::chrono::seconds(1);
+constexpr auto kRetryDelayMax = std::chrono::seconds(60);
+
+/**
+ * @brief 与 Redis 待上报集合重新同步的周期。
+ */
+constexpr auto kReportResyncInterval = std::chrono::seconds(60);
+
+/**
+ * @brief 上报阶段主线程函数。
+ *
+ * 从 report_queue 中取出新域名攒批，批次达到自适应目标大小、字节上限或等待超过 kReportLinger 后
+ * 提交给上报线程执行；失败批次按指数退避重试。逐批次统计（大小、等待时间、往返时间）随重新同步周期
+ * 及退出时打印。收到 stop_reporting 后发送剩余域名、等待进行中的请求完成后返回。
+ *
+ * @param cache DomainStore 实例，用于读取/移除待上报集合并写回判定结果。
+ * @param report_queue 缓存阶段写入的新域名队列。
+ * @param stop_reporting 原子标志，若为 true 则结束上报阶段（应在缓存阶段退出后设置）。
+ * @param reporter DomainReporter 实例，执行 HTTP 上报。
+ */
+void report_processor(
+    DomainStore& cache,
+    ReportQueue& report_queue,
+    std::atomic<bool>& stop_reporting,
+    DomainReporter& reporter
+);
+
+#endif // REPORT_PROCESSOR_H
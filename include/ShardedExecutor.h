@@ -0,0 +1,76 @@
+// ShardedExecutor.h
+#ifndef SHARDED_EXECUTOR_H
+#define SHARDED_EXECUTOR_H
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <string_view>
+
+#include "Task.h"
+
+/**
+ * @brief 按键亲和的分片执行器
+ *
+ * 每个分片由一个独立线程和一个任务队列组成。调用方先通过 shard_for() 将键（域名）
+ * 哈希到固定分片，再把任务提交到该分片：同一个键的所有任务始终由同一线程按提交顺序执行，
+ * 因此无需全局锁即可保证单个域名的更新顺序，不同域名的更新在各分片上并行执行。
+ */
+class ShardedExecutor {
+public:
+    /**
+     * @brief 构造函数，启动 shard_count 个分片线程
+     * @param shard_count 分片数量（为 0 时按 1 处理）
+     */
+    explicit ShardedExecutor(size_t shard_count);
+
+    /**
+     * @brief 析构函数，执行完所有已提交的任务后停止并回收分片线程
+     */
+    ~ShardedExecutor();
+
+    ShardedExecutor(const ShardedExecutor&) = delete;
+    ShardedExecutor& operator=(const ShardedExecutor&) = delete;
+
+    /**
+     * @brief 计算键所属的分片编号
+     *
+     * @param key 分片键（如域名）
+     * @return size_t 分片编号，范围 [0, size())
+     */
+    size_t shard_for(std::string_view key) const;
+
+    /**
+     * @brief 向指定分片提交任务（发射后不管）
+     *
+     * @param shard 分片编号，通常由 shard_for() 得到
+     * @param task 任务
+     */
+    void submit(size_t shard, Task task);
+
+    /**
+     * @brief 分片数量
+     */
+    size_t size() const { return shards.size(); }
+
+private:
+    // 单个分片：一个线程独占处理一个任务队列
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<Task> tasks;
+        std::thread worker;
+    };
+
+    void worker_loop(Shard& shard);
+
+    std::vector<std::unique_ptr<Shard>> shards;  ///< 分片列表
+    std::atomic<bool> stop{false};               ///< 停止标志
+};
+
+#endif // SHARDED_EXECUTOR_H
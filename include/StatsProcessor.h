@@ -4,24 +4,24 @@
 #pragma once
 
 #include <atomic>  // 用于 std::atomic 类型
-#include "RedisDNSCache.h"
+#include "DomainStore.h"
 #include "DomainReporter.h"
 
 /**
  * @brief 统计上报处理线程主函数
  * 
- * 在指定的间隔时间内（interval_seconds），定期从 RedisDNSCache 中
+ * 在指定的间隔时间内（interval_seconds），定期从 DomainStore 中
  * 获取域名访问数据，并通过 DomainReporter 上报至远程服务器。
  * 
  * 该函数通常在单独线程中运行，直到 stop_processing 变为 true 后退出。
  * 
- * @param cache 引用 RedisDNSCache 实例，用于访问缓存数据
+ * @param cache 引用 DomainStore 实例，用于访问缓存数据
  * @param stop_processing 线程退出标志，外部设置为 true 后线程安全退出
  * @param reporter 用于上报数据的 DomainReporter 单例实例
  * @param interval_seconds 上报的时间间隔，单位为秒
  */
 void stats_processor(
-    RedisDNSCache& cache,
+    DomainStore& cache,
     std::atomic<bool>& stop_processing,
     DomainReporter& reporter,
     int interval_seconds
@@ -0,0 +1,106 @@
+#ifndef WHITELIST_H
+#define WHITELIST_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief 不可变的白名单匹配器（按 label 反向的后缀树）
+ *
+ * 规则与判定服务器（dns_server.lua）相同：
+ * - "example.com"   精确匹配 example.com；
+ * - "*.example.com" 匹配 example.com 本身及其任意子域名。
+ *
+ * 域名按 label 从右到左逐级查找（com → example → www），每个 label 只计算一次哈希，
+ * 匹配代价只与域名的 label 数有关，与名单规模无关。所有边存放在一张开放寻址表中
+ * （键为 父节点 + label），label 文本集中存放在一块连续内存里，百万级名单也只需少量大块分配。
+ *
+ * 构建完成后只读，可被任意多个线程同时查询；名单变化时构建新实例整体替换（见 Whitelist）。
+ */
+class WhitelistMatcher {
+public:
+    /**
+     * @brief 由规则列表构建（空行与 # 开头的注释行忽略，规则转为小写，末尾的 '.' 去掉）
+     */
+    static std::shared_ptr<const WhitelistMatcher> build(const std::vector<std::string>& patterns);
+
+    /**
+     * @brief 读取名单文件（每行一条规则）并构建，文件无法打开时抛出 std::runtime_error
+     */
+    static std::shared_ptr<const WhitelistMatcher> load(const std::string& path);
+
+    /**
+     * @brief 判断域名是否在白名单中（域名应已规范化为小写，允许末尾带一个 '.'）
+     */
+    bool matches(std::string_view domain) const;
+
+    /**
+     * @brief 有效规则数
+     */
+    size_t patterns() const { return pattern_count_; }
+
+    /**
+     * @brief 树中的节点数（含根节点）
+     */
+    size_t nodes() const { return flags_.size(); }
+
+private:
+    WhitelistMatcher();
+
+    static constexpr uint32_t kNone = 0;  // 根节点编号为 0，不会作为子节点出现
+
+    struct Edge {
+        uint64_t hash = 0;
+        uint32_t parent = 0;
+        uint32_t child = kNone;     // kNone 表示空槽
+        uint32_t label_offset = 0;  // label 在 labels_ 中的位置
+        uint32_t label_len = 0;
+    };
+
+    void add(std::string_view pattern);
+    uint32_t find_child(uint32_t parent, std::string_view label, uint64_t hash) const;
+    uint32_t add_child(uint32_t parent, std::string_view label);
+    void grow();
+
+    std::vector<Edge> edges_;      // 开放寻址（线性探测），容量为 2 的幂
+    size_t edge_count_ = 0;
+    std::vector<uint8_t> flags_;   // 每个节点的标记（EXACT / WILDCARD）
+    std::string labels_;           // 所有 label 文本
+    size_t pattern_count_ = 0;
+};
+
+/**
+ * @brief 白名单持有者：以 RCU 方式发布不可变的 WhitelistMatcher
+ *
+ * 查询方取得当前实例的 shared_ptr 快照后无锁查询；重新加载时新实例在调用方线程中构建完成，
+ * 再用一次原子的指针替换发布，旧实例在最后一个快照释放后销毁。重新加载不会阻塞查询，
+ * 加载失败时保留原名单。
+ */
+class Whitelist {
+public:
+    /**
+     * @brief 当前匹配器的快照（未加载过名单时为 nullptr）
+     */
+    std::shared_ptr<const WhitelistMatcher> snapshot() const;
+
+    /**
+     * @brief 发布新的匹配器
+     */
+    void publish(std::shared_ptr<const WhitelistMatcher> matcher);
+
+    /**
+     * @brief 从文件重新加载并发布，失败时记录日志并保留原名单
+     * @return true 表示加载成功
+     */
+    bool reload(const std::string& path);
+
+private:
+    std::shared_ptr<const WhitelistMatcher> current_;  // 只通过 std::atomic_load / atomic_store 访问
+};
+
+#endif // WHITELIST_H
@@ -0,0 +1,37 @@
+#ifndef WHITELIST_WATCHER_H
+#define WHITELIST_WATCHER_H
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "Whitelist.h"
+
+/**
+ * @brief 白名单文件变化检查周期
+ */
+constexpr auto kWhitelistPollInterval = std::chrono::seconds(5);
+
+/**
+ * @brief 白名单监视线程主函数
+ *
+ * 每 kWhitelistPollInterval 检查一次名单文件的修改时间与大小，发生变化时在本线程中构建新的
+ * WhitelistMatcher 并原子替换（见 Whitelist::reload），查询线程在整个过程中不被阻塞。
+ *
+ * @param whitelist 白名单持有者（启动前应已完成首次加载）
+ * @param path 名单文件路径
+ * @param stop_processing 线程退出标志，外部设置为 true 后线程退出
+ */
+void whitelist_watcher(
+    Whitelist& whitelist,
+    const std::string& path,
+    std::atomic<bool>& stop_processing
+);
+
+/**
+ * @brief 唤醒 whitelist_watcher 线程，使其尽快检查退出标志
+ */
+void stop_whitelist_watcher();
+
+#endif // WHITELIST_WATCHER_H
@@ -0,0 +1,104 @@
+// WorkStealingPool.h
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <memory>
+
+#include "Task.h"
+
+/**
+ * @brief 工作窃取线程池
+ *
+ * 每个工作线程持有自己的任务双端队列：工作线程内部提交的任务压入自身队尾并按 LIFO 取出
+ * （缓存友好），外部线程提交的任务按轮询分散到各队列；自身队列为空时从其他线程队首窃取（FIFO）。
+ * 各队列独立加锁，提交与取任务不再争用同一把全局锁。
+ *
+ * 任务以只可移动的 Task 存放（小对象内联存储），submit() 为“发射后不管”接口，
+ * 不创建 future、不产生 shared_ptr 分配；需要结果时使用 enqueue()。
+ */
+class WorkStealingPool {
+public:
+    /**
+     * @brief 构造函数，启动指定数量的工作线程
+     * @param thread_count 工作线程数量（为 0 时按 1 处理）
+     */
+    explicit WorkStealingPool(size_t thread_count);
+
+    /**
+     * @brief 析构函数，执行完所有已提交的任务后停止并回收工作线程
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief 提交一个无需返回值的任务（发射后不管）
+     *
+     * @tparam F 可调用对象类型，签名为 void()，只需可移动
+     * @param f 任务
+     */
+    template<class F>
+    void submit(F&& f);
+
+    /**
+     * @brief 提交任务并返回 future（接口与 ThreadPool::enqueue 一致）
+     *
+     * @tparam F 任务类型（可调用对象）
+     * @tparam Args 任务参数类型
+     * @param f 任务函数或可调用对象
+     * @param args 传递给任务函数的参数
+     * @return std::future<任务返回类型> 任务执行结果的 future
+     */
+    template<class F, class... Args>
+    auto enqueue(F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result_t<F, Args...>>;
+
+    /**
+     * @brief 工作线程数量
+     */
+    size_t size() const { return workers.size(); }
+
+private:
+    // 单个工作线程的任务队列，按缓存行对齐避免相邻队列伪共享
+    struct alignas(64) WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // 当前线程所属的线程池及其工作线程编号（非工作线程时 pool 为 nullptr）
+    struct WorkerIdentity {
+        const WorkStealingPool* pool;
+        size_t index;
+    };
+    static WorkerIdentity& current_worker();
+
+    void push_task(Task task);
+    bool pop_local(size_t index, Task& task);
+    bool steal(size_t index, Task& task);
+    void worker_loop(size_t index);
+
+    std::vector<std::thread> workers;                  ///< 工作线程容器
+    std::vector<std::unique_ptr<WorkQueue>> queues;    ///< 每个工作线程一个任务队列
+
+    std::atomic<size_t> next_queue{0};                 ///< 外部提交时的轮询位置
+    std::atomic<size_t> pending{0};                    ///< 已提交但尚未被取走的任务数
+    std::atomic<size_t> sleepers{0};                   ///< 正在休眠的工作线程数
+
+    std::mutex sleep_mutex;                            ///< 休眠/唤醒互斥锁
+    std::condition_variable wakeup;                    ///< 空闲线程在此等待新任务
+    std::atomic<bool> stop{false};                     ///< 停止标志
+};
+
+#include "WorkStealingPool.tpp"  // 模板函数实现
+
+#endif // WORK_STEALING_POOL_H
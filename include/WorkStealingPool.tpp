@@ -0,0 +1,156 @@
+// WorkStealingPool.tpp
+#pragma once
+
+#include <iostream>
+#include <exception>
+
+#include "WorkStealingPool.h"
+
+/**
+ * @brief 构造函数，为每个工作线程创建任务队列并启动线程
+ *
+ * @param thread_count 工作线程数量
+ */
+inline WorkStealingPool::WorkStealingPool(size_t thread_count) {
+    if (thread_count == 0) thread_count = 1;
+
+    // 先创建全部队列，再启动线程：工作线程启动后即可能窃取任意队列
+    for (size_t i = 0; i < thread_count; ++i) {
+        queues.emplace_back(new WorkQueue);
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+/**
+ * @brief 析构函数，设置停止标志并唤醒所有线程
+ *
+ * 工作线程在所有已提交任务执行完毕后才退出，随后 join 全部线程。
+ */
+inline WorkStealingPool::~WorkStealingPool() {
+    stop = true;
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        wakeup.notify_all();
+    }
+    for (std::thread& worker : workers)
+        if (worker.joinable()) worker.join();
+}
+
+inline WorkStealingPool::WorkerIdentity& WorkStealingPool::current_worker() {
+    thread_local WorkerIdentity identity{nullptr, 0};
+    return identity;
+}
+
+/**
+ * @brief 将任务放入队列并在有空闲线程时唤醒一个
+ *
+ * 工作线程提交的任务放入自身队列，外部线程提交的任务按轮询分配。
+ */
+inline void WorkStealingPool::push_task(Task task) {
+    const WorkerIdentity& self = current_worker();
+    size_t index = (self.pool == this)
+        ? self.index
+        : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    pending.fetch_add(1);
+
+    // 与 worker_loop 中 sleepers++ → 检查 pending 的顺序相对：
+    // 两侧均为顺序一致的原子操作，至少一方能看到对方的修改，不会丢失唤醒
+    if (sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        wakeup.notify_one();
+    }
+}
+
+// 从自身队列尾部取任务（LIFO，最近提交的任务数据更可能仍在缓存中）
+inline bool WorkStealingPool::pop_local(size_t index, Task& task) {
+    WorkQueue& q = *queues[index];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) return false;
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    pending.fetch_sub(1);
+    return true;
+}
+
+// 依次从其他线程队列头部窃取任务（FIFO，取走最早提交的任务）
+inline bool WorkStealingPool::steal(size_t index, Task& task) {
+    size_t n = queues.size();
+    for (size_t k = 1; k < n; ++k) {
+        WorkQueue& q = *queues[(index + k) % n];
+        std::unique_lock<std::mutex> lock(q.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || q.tasks.empty()) continue;
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        pending.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 工作线程主循环
+ *
+ * 优先执行自身队列中的任务，其次窃取其他队列；均无任务时休眠，
+ * 直到有新任务提交或线程池停止（停止时仍会先执行完剩余任务）。
+ */
+inline void WorkStealingPool::worker_loop(size_t index) {
+    current_worker() = WorkerIdentity{this, index};
+
+    Task task;
+    for (;;) {
+        if (pop_local(index, task) || steal(index, task)) {
+            try {
+                task();
+            } catch (const std::exception& e) {
+                std::cerr << "[WorkStealingPool] task error: " << e.what() << std::endl;
+            }
+            task = Task();  // 及时释放任务持有的资源
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleepers.fetch_add(1);
+        wakeup.wait(lock, [this] {
+            return stop.load() || pending.load() > 0;
+        });
+        sleepers.fetch_sub(1);
+
+        // 停止且没有剩余任务，线程退出
+        if (stop && pending.load() == 0) return;
+    }
+}
+
+/**
+ * @brief 提交无需返回值的任务
+ *
+ * 可调用对象直接移动进 Task，小对象不产生堆分配。
+ */
+template<class F>
+void WorkStealingPool::submit(F&& f) {
+    push_task(Task(std::forward<F>(f)));
+}
+
+/**
+ * @brief 提交任务并返回 future
+ *
+ * std::packaged_task 本身只可移动，直接存入 Task，无需 shared_ptr 包装。
+ */
+template<class F, class... Args>
+auto WorkStealingPool::enqueue(F&& f, Args&&... args)
+    -> std::future<typename std::invoke_result_t<F, Args...>> {
+    using return_type = typename std::invoke_result_t<F, Args...>;
+
+    std::packaged_task<return_type()> task(
+        std::bind(std::forward<F>(f), std::forward<Args>(args)...)
+    );
+    std::future<return_type> result = task.get_future();
+    submit(std::move(task));
+    return result;
+}
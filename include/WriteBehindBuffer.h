@@ -0,0 +1,89 @@
+#ifndef WRITE_BEHIND_BUFFER_H
+#define WRITE_BEHIND_BUFFER_H
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 写回缓冲区分片数（每个分片独立加锁）
+constexpr size_t WRITE_BEHIND_SHARDS = 16;
+
+// 待刷新域名数达到该值时立即刷新（大小触发），同时也是缓冲区容量：
+// 缓冲区满时新域名的增量直接丢弃（已有域名仍可合并），崩溃时可能丢失计数的域名数不超过该值
+constexpr size_t WRITE_BEHIND_MAX_PENDING = 1 << 14;
+
+// 刷新失败后，大小触发的刷新至少间隔该时长（周期刷新不受影响），避免 Redis 不可用时每次查询都重试
+constexpr auto WRITE_BEHIND_RETRY_DELAY = std::chrono::seconds(1);
+
+// 单个刷新脚本（一次 EVAL）处理的最大域名数
+constexpr size_t WRITE_BEHIND_FLUSH_BATCH = 512;
+
+/**
+ * @brief 访问次数写回（write-behind）缓冲区
+ *
+ * 已缓存域名的重复查询只在内存中按域名累加命中次数并记录最后访问时间，
+ * 由刷新线程按周期（或待刷新域名数达到 WRITE_BEHIND_MAX_PENDING 时）批量写回 Redis，
+ * 使 Redis 写入量只与刷新周期内的不同域名数有关，而不随查询速率增长。
+ *
+ * 同一域名在两次刷新之间的多次累加合并为一条；本类只负责内存中的聚合，写回由 RedisDNSCache 完成。
+ * 缓冲区最多容纳 capacity 个不同域名，Redis 长时间不可用时内存占用与丢失范围都有上限。
+ */
+class WriteBehindBuffer {
+public:
+    /**
+     * @brief 一个域名在两次刷新之间累积的增量
+     */
+    struct Delta {
+        uint32_t hits = 0;          // 新增访问次数
+        time_t last_accessed = 0;   // 最后一次访问时间（秒）
+    };
+
+    explicit WriteBehindBuffer(size_t capacity = WRITE_BEHIND_MAX_PENDING);
+    ~WriteBehindBuffer();
+
+    WriteBehindBuffer(const WriteBehindBuffer&) = delete;
+    WriteBehindBuffer& operator=(const WriteBehindBuffer&) = delete;
+
+    /**
+     * @brief 累加一个域名的访问次数；缓冲区已满且域名不在其中时丢弃本次增量（计入 dropped）
+     * @return true 增量已接纳；false 增量被丢弃
+     */
+    bool add(const std::string& domain, uint32_t hits, time_t now);
+
+    /**
+     * @brief 取走全部待刷新的增量（追加到 out）
+     */
+    void drain(std::vector<std::pair<std::string, Delta>>& out);
+
+    /**
+     * @brief 当前待刷新的域名数
+     */
+    size_t size() const { return pending.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 因缓冲区已满而丢弃的增量数
+     */
+    uint64_t dropped() const { return dropped_deltas.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Delta> deltas;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t capacity;
+    std::atomic<size_t> pending{0};
+    std::atomic<uint64_t> dropped_deltas{0};
+};
+
+#endif // WRITE_BEHIND_BUFFER_H
@@ -3,9 +3,10 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
-#include <optional>
 
 /**
  * @file dns_parse.h
@@ -13,31 +14,124 @@
  *
  * 本模块用于提取DNS查询报文中的域名，支持处理压缩指针格式（RFC 1035），
  * 适用于网络抓包、DNS嗅探器、IDS系统等需要解析DNS数据的应用。
+ *
+ * 解析直接在抓包缓冲区上进行（ByteSpan 不持有数据），域名写入调用方提供的
+ * DnsNameArena，结果以 std::string_view 指向 arena，稳态下不产生堆分配。
  */
 
+// 点分形式域名的最大长度（RFC 1035：wire 格式不超过 255 字节）
+constexpr size_t DNS_MAX_NAME_LEN = 255;
+
+// 单个报文中最多解析的问题数（实际报文 QDCOUNT 几乎总是 1）
+constexpr size_t DNS_MAX_QUESTIONS = 8;
+
+// 压缩指针最大跳转次数（防止压缩环路）
+constexpr int DNS_MAX_POINTER_JUMPS = 5;
+
 /**
- * @brief 从DNS报文中提取所有查询的域名（仅支持Query部分，不含响应）
+ * @brief 不持有数据的只读字节区间（UDP 负载）
+ */
+struct ByteSpan {
+    const uint8_t* data;
+    size_t size;
+};
+
+/**
+ * @brief 调用方持有的域名缓冲区
  *
- * @param packet 整个DNS报文的字节数组（UDP负载部分）
- * @return std::vector<std::string> 所有查询的问题域名列表（最多QDCOUNT个）
+ * 固定容量，可容纳 DNS_MAX_QUESTIONS 个最长域名。通常每个抓包线程持有一个，
+ * 每个报文解析前调用 clear() 复用。从中得到的 string_view 在下次 clear() 前有效。
+ */
+class DnsNameArena {
+public:
+    static constexpr size_t CAPACITY = DNS_MAX_QUESTIONS * (DNS_MAX_NAME_LEN + 1);
+
+    // 清空缓冲区（不释放内存）
+    void clear() { used_ = 0; }
+
+    // 剩余可写入的字节数
+    size_t remaining() const { return CAPACITY - used_; }
+
+    // 当前写入位置
+    char* cursor() { return buf_ + used_; }
+
+    // 确认写入 n 字节，返回指向这段数据的视图
+    std::string_view commit(size_t n) {
+        std::string_view view(buf_ + used_, n);
+        used_ += n;
+        return view;
+    }
+
+private:
+    char buf_[CAPACITY];
+    size_t used_ = 0;
+};
+
+/**
+ * @brief DNS 报文头中与查询记录相关的字段
+ */
+struct DnsHeader {
+    uint16_t id;       // 事务 ID
+    uint16_t flags;    // 标志位（最高位为 QR）
+    uint16_t qdcount;  // 问题数
+};
+
+/**
+ * @brief 读取 DNS 报文头
  *
- * 要求 packet 长度必须至少12字节（DNS header），否则返回空。
- * 若 QDCOUNT 为 0 或解析失败，则返回空列表。
+ * @return true 成功；false 报文不足 12 字节
  */
-std::vector<std::string> extract_dns_queries(const std::vector<uint8_t>& packet);
+bool read_dns_header(ByteSpan packet, DnsHeader& header);
+
+/**
+ * @brief 一个 DNS 问题记录（QNAME 指向 DnsNameArena）
+ */
+struct DnsQuestion {
+    std::string_view name;  // 点分形式域名
+    uint16_t qtype;         // 查询类型（如 1 = A，28 = AAAA）
+    uint16_t qclass;        // 查询类（通常为 1 = IN）
+};
 
 /**
- * @brief 从DNS报文当前位置开始读取一个域名（支持压缩格式）
+ * @brief 从DNS报文当前位置开始读取一个域名（支持压缩格式），写入调用方缓冲区
  *
- * @param packet DNS报文的字节数组（UDP负载）
- * @param pos 当前读取位置，调用后将被更新为域名后的新位置
- * @param max_len 报文的最大长度（用于越界保护）
- * @param jump_limit 跳转次数限制（防止死循环压缩解析）
- * @return std::string 解析得到的完整域名；若格式错误可返回空字符串或异常（具体取决于实现）
+ * @param packet DNS报文（UDP负载）
+ * @param pos 当前读取位置，成功后更新为该域名在报文中所占字节之后的位置
+ * @param out 输出缓冲区，写入点分形式域名（不含结尾 '\0'）
+ * @param out_cap 输出缓冲区容量
+ * @param out_len 成功时写入的域名长度
+ * @param jump_limit 压缩指针跳转次数限制（防止死循环压缩解析）
+ * @return true 解析成功；false 报文越界、标签非法、域名过长或压缩指针成环
  *
  * 域名以标签序列表示，如 [3]www[6]google[3]com[0]，或使用压缩指针（0xC0开头）。
- * 函数支持递归解析压缩指针引用的域名。
+ * 压缩指针以迭代方式跟随，不做递归。输出为规范化后的小写形式（见 domain_canon.h），
+ * label 中含非法字节时整个域名视为无效。
  */
-std::optional<std::string> read_domain_name(const std::vector<uint8_t>& packet, size_t& pos, size_t max_len, int jump_limit = 5);
+bool read_domain_name(ByteSpan packet, size_t& pos, char* out, size_t out_cap,
+                      size_t& out_len, int jump_limit = DNS_MAX_POINTER_JUMPS);
+
+/**
+ * @brief 从DNS报文中提取问题部分（不含响应记录），不产生堆分配
+ *
+ * @param packet DNS报文（UDP负载）
+ * @param arena 域名输出缓冲区，调用前应由调用方 clear()
+ * @param out 问题记录输出数组
+ * @param max_out out 数组容量
+ * @return size_t 成功解析的问题数；遇到格式错误时返回此前已解析的数量
+ *
+ * 要求 packet 长度至少12字节（DNS header），否则返回 0。
+ */
+size_t extract_dns_questions(ByteSpan packet, DnsNameArena& arena,
+                             DnsQuestion* out, size_t max_out);
+
+/**
+ * @brief 从DNS报文中提取所有查询的域名（便捷接口，返回拷贝）
+ *
+ * @param packet 整个DNS报文的字节数组（UDP负载部分）
+ * @return std::vector<std::string> 所有查询的问题域名列表（最多 DNS_MAX_QUESTIONS 个）
+ *
+ * 基于 extract_dns_questions 实现，会为结果分配内存，不适合在抓包热路径上使用。
+ */
+std::vector<std::string> extract_dns_queries(const std::vector<uint8_t>& packet);
 
 #endif // DNS_PARSE_H
@@ -0,0 +1,36 @@
+#ifndef DOMAIN_CANON_H
+#define DOMAIN_CANON_H
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file domain_canon.h
+ * @brief 域名规范化内核：转小写、字符校验与拷贝在一次遍历中完成
+ *
+ * 客户端的 0x20 大小写随机化会让同一个域名以多种大小写形式出现，
+ * 若不做规范化，会在 Redis 中产生多个缓存条目与多次上报。
+ *
+ * 合法字符为 [A-Za-z0-9-_]（下划线用于 _dmarc、SRV 等服务名），其余字节
+ * （包括 '.'、空白、控制字符与非 ASCII 字节）一律视为非法。
+ *
+ * 编译时按指令集选择实现：AVX2（需 -mavx2）> SSE2（x86-64 默认可用）> 标量查表。
+ */
+
+/**
+ * @brief 规范化单个 label：小写化后写入 dst，并校验每个字节
+ *
+ * @param src label 内容（不含长度前缀），只读取 [src, src + len)
+ * @param len label 长度（0~63）
+ * @param dst 输出位置，只写入 [dst, dst + len)
+ * @return true 全部字节合法；false 存在非法字节（dst 内容未定义）
+ */
+bool canonicalize_label(const uint8_t* src, size_t len, char* dst);
+
+/**
+ * @brief 当前编译所使用的规范化实现名称（"avx2" / "sse2" / "scalar"）
+ */
+const char* canonicalize_impl_name();
+
+#endif // DOMAIN_CANON_H
@@ -4,7 +4,10 @@
 
 #include <atomic>
 #include <string>
-#include "ThreadSafeQueue.h"
+#include <cstdint>
+#include <sys/types.h>
+#include "BoundedMPMCQueue.h"
+#include "query_record.h"
 
 /**
  * @file pcap_capture.h
@@ -13,6 +16,8 @@
  * 提供启动抓包功能和跨线程通信的域名队列定义。
  */
 
+struct pcap_pkthdr;
+
 // DNS 协议使用的默认端口
 constexpr int DNS_PORT = 53;
 
@@ -22,18 +27,70 @@ constexpr int ETHERNET_HEADER_LEN = 14;
 // 控制抓包是否停止的原子标志位（用于主线程通知退出）
 extern std::atomic<bool> stop_processing;
 
-// 域名结果的线程安全队列（供处理线程消费）
-extern ThreadSafeQueue<std::string> domain_queue;
+// 查询记录队列默认容量（条）
+constexpr size_t DOMAIN_QUEUE_CAPACITY = 1 << 16;
+
+// 抓包线程与处理线程之间的查询记录队列类型（有界、无锁）
+using DomainQueue = BoundedMPMCQueue<QueryRecord>;
+
+// 查询记录队列（抓包线程写入，供处理线程消费）
+extern DomainQueue domain_queue;
+
+/**
+ * @brief 抓包后端类型
+ */
+enum class CaptureBackend {
+    PCAP,        // libpcap：pcap_open_live + pcap_next_ex 逐包读取
+    TPACKET_V3   // AF_PACKET TPACKET_V3 内存映射环形缓冲区，按块批量遍历
+};
+
+/**
+ * @brief 抓包统计信息（来自内核计数器）
+ *
+ * PCAP 后端对应 pcap_stats，TPACKET_V3 后端对应 PACKET_STATISTICS。
+ */
+struct CaptureStats {
+    uint64_t packets_received = 0;   // 内核收到的报文数（含被丢弃的报文）
+    uint64_t packets_dropped = 0;    // 因缓冲区不足被内核丢弃的报文数
+    uint64_t if_dropped = 0;         // 网卡/驱动层丢弃数（仅 PCAP 后端）
+    uint64_t freeze_count = 0;       // 环形缓冲区冻结次数（仅 TPACKET_V3 后端）
+};
+
+/**
+ * @brief 解析单个以太网帧并将其中的每个 DNS 问题作为 QueryRecord 推入 domain_queue
+ *
+ * 兼容 pcap_handler 回调签名，libpcap 与 TPACKET_V3 两种后端共用该函数。
+ *
+ * @param user 若非空，则指向调用方的 std::vector<QueryRecord> 批量缓存，
+ *             记录追加到该缓存中而不直接入队；为空时逐个推入 domain_queue
+ * @param header 报文头（时间戳、捕获长度、原始长度）
+ * @param packet 从以太网头开始的报文数据
+ */
+void packet_handler(u_char* user, const struct pcap_pkthdr* header, const u_char* packet);
 
 /**
  * @brief 启动指定网卡的 DNS 报文抓取
  * 
- * 使用 libpcap 打开指定网卡并启动数据包抓取，解析出 DNS 请求域名并推入 domain_queue 队列。
+ * 打开指定网卡并启动数据包抓取，解析出 DNS 请求域名并推入 domain_queue 队列。
  * 该函数会阻塞运行直到 stop_processing 被置为 true。
  *
  * @param dev 网卡名称（如 "eth0", "ens33"）
+ * @param backend 抓包后端，默认使用 libpcap
  */
-void start_packet_capture(const std::string& dev);
+void start_packet_capture(const std::string& dev, CaptureBackend backend = CaptureBackend::PCAP);
+
+/**
+ * @brief 启动多线程 fanout 抓包（TPACKET_V3 + PACKET_FANOUT）
+ *
+ * 启动 thread_count 个抓包线程，各自持有独立的环形缓冲区并加入同一 fanout 组，
+ * 内核按流哈希分发报文，使解析工作分摊到多个 CPU 核心。
+ * 所有线程建立成功后才开始抓包，任一线程建立失败时整体放弃并报告失败的线程数。
+ * 该函数会阻塞运行直到所有抓包线程退出。
+ *
+ * @param dev 网卡名称
+ * @param thread_count 抓包线程数量（≥ 1）
+ */
+void start_fanout_capture(const std::string& dev, size_t thread_count);
 
 /**
  * @brief 停止抓包线程
@@ -43,4 +100,19 @@ void start_packet_capture(const std::string& dev);
  */
 void stop_packet_capture();
 
+/**
+ * @brief 获取当前累计的抓包统计信息（线程安全）
+ *
+ * 统计由抓包线程周期性（约每秒）从内核读取并累加，可用于在同一网卡上
+ * 对比 PCAP 与 TPACKET_V3 两种后端的丢包情况。
+ */
+CaptureStats get_capture_stats();
+
+/**
+ * @brief 累加一次内核统计增量（供各抓包后端调用）
+ *
+ * @param delta 自上次读取以来的统计增量
+ */
+void accumulate_capture_stats(const CaptureStats& delta);
+
 #endif // PCAP_CAPTURE_H
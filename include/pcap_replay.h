@@ -0,0 +1,31 @@
+#ifndef PCAP_REPLAY_H
+#define PCAP_REPLAY_H
+#pragma once
+
+#include <string>
+
+/**
+ * @file pcap_replay.h
+ * @brief 离线回放 .pcap/.pcapng 文件，复用在线抓包的 packet_handler 解析路径
+ *
+ * 用于在没有真实网卡流量的环境下（例如笔记本 + 本地 redis-server）
+ * 可重复地测量 抓包 → Redis 的整体吞吐。
+ */
+
+// 回放速度：尽可能快（忽略报文时间戳）
+constexpr double REPLAY_SPEED_MAX = 0.0;
+
+/**
+ * @brief 回放抓包文件中的所有报文
+ *
+ * 每个报文都交给 packet_handler 处理，解析出的域名推入 domain_queue。
+ * 回放过程中若 stop_processing 被置为 true 则提前结束。
+ *
+ * @param file 抓包文件路径（.pcap 或 .pcapng，链路层须为以太网）
+ * @param speed 回放速度：REPLAY_SPEED_MAX 表示尽可能快；1.0 表示按原始时间间隔；
+ *              N 表示 N 倍速
+ * @return true 文件完整回放；false 打开失败或中途出错
+ */
+bool start_pcap_replay(const std::string& file, double speed);
+
+#endif // PCAP_REPLAY_H
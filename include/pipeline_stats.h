@@ -0,0 +1,85 @@
+#ifndef PIPELINE_STATS_H
+#define PIPELINE_STATS_H
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @file pipeline_stats.h
+ * @brief 抓包 → 解析 → 缓存 → 上报 各阶段的吞吐与耗时统计
+ *
+ * 默认关闭，开启后（如离线回放模式）各阶段会累加处理数量与耗时，
+ * 用于在没有真实流量的环境下测量整条流水线的吞吐能力。
+ */
+struct PipelineStats {
+    std::atomic<bool> enabled{false};          // 是否开启统计
+
+    std::atomic<uint64_t> packets{0};          // 读取到的报文数
+    std::atomic<uint64_t> domains_queued{0};   // 推入 domain_queue 的域名数
+    std::atomic<uint64_t> domains_done{0};     // 缓存阶段处理完成的域名数
+
+    std::atomic<uint64_t> capture_ns{0};       // 读取报文耗时（不含回放限速等待）
+    std::atomic<uint64_t> parse_ns{0};         // 报文解析与入队耗时
+    std::atomic<uint64_t> cache_ns{0};         // 缓存更新耗时（不含上报）
+    std::atomic<uint64_t> report_ns{0};        // 域名上报耗时
+};
+
+// 全局流水线统计实例
+extern PipelineStats pipeline_stats;
+
+/**
+ * @brief 阶段计时器：构造时记录起点，析构时将耗时累加到指定计数器
+ *
+ * 统计未开启时不读取时钟，开销可忽略。
+ */
+class StageTimer {
+public:
+    explicit StageTimer(std::atomic<uint64_t>& counter)
+        : counter_(counter), active_(pipeline_stats.enabled.load(std::memory_order_relaxed)) {
+        if (active_) start_ = std::chrono::steady_clock::now();
+    }
+
+    ~StageTimer() {
+        if (!active_) return;
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        counter_.fetch_add(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+            std::memory_order_relaxed);
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    std::atomic<uint64_t>& counter_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief 统计开启时对计数器加一
+ */
+inline void pipeline_count(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+    if (pipeline_stats.enabled.load(std::memory_order_relaxed)) {
+        counter.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief 等待缓存阶段处理完所有已入队的域名
+ *
+ * @param timeout 最长等待时间
+ * @return true 已全部处理完成；false 超时
+ */
+bool wait_pipeline_drained(std::chrono::seconds timeout);
+
+/**
+ * @brief 打印吞吐报告（报文/秒、域名/秒及各阶段耗时）
+ *
+ * @param elapsed_sec 统计区间的墙钟时长（秒）
+ */
+void print_pipeline_report(double elapsed_sec);
+
+#endif // PIPELINE_STATS_H
@@ -0,0 +1,46 @@
+#ifndef QUERY_RECORD_H
+#define QUERY_RECORD_H
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include "dns_parse.h"
+
+/**
+ * @file query_record.h
+ * @brief 抓包线程到缓存处理线程之间传递的定长查询记录
+ *
+ * 记录为平凡可复制（trivially copyable）类型，域名内联存储，入队/出队只是一次
+ * 定长内存拷贝，不涉及堆分配。除域名外还保留了查询类型、客户端地址、事务 ID
+ * 与抓包时间戳，下游阶段可直接使用而无需重新解析报文。
+ */
+struct QueryRecord {
+    char name[DNS_MAX_NAME_LEN + 1];  // 规范化后的点分域名，以 '\0' 结尾
+    uint8_t name_len;                 // 域名长度；为 0 表示空记录（用作唤醒/退出标志）
+    uint8_t ip_version;               // 客户端地址族：4 或 6
+    uint16_t qtype;                   // 查询类型（如 1 = A，28 = AAAA）
+    uint16_t txid;                    // DNS 事务 ID
+    uint8_t client_ip[16];            // 客户端地址（网络字节序，IPv4 占前 4 字节）
+    int64_t ts_usec;                  // 抓包时间戳（微秒，Unix 纪元）
+
+    // 域名视图（指向记录内部，记录存活期间有效）
+    std::string_view domain() const { return std::string_view(name, name_len); }
+
+    // 是否为空记录
+    bool empty() const { return name_len == 0; }
+
+    // 设置域名（超长部分截断到 DNS_MAX_NAME_LEN）
+    void set_domain(std::string_view d) {
+        size_t n = d.size() < DNS_MAX_NAME_LEN ? d.size() : DNS_MAX_NAME_LEN;
+        std::memcpy(name, d.data(), n);
+        name[n] = '\0';
+        name_len = static_cast<uint8_t>(n);
+    }
+};
+
+static_assert(std::is_trivially_copyable<QueryRecord>::value,
+              "QueryRecord must stay trivially copyable");
+
+#endif // QUERY_RECORD_H
@@ -0,0 +1,78 @@
+#ifndef RING_CAPTURE_H
+#define RING_CAPTURE_H
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/**
+ * @file ring_capture.h
+ * @brief 基于 AF_PACKET TPACKET_V3 内存映射环形缓冲区的抓包后端
+ *
+ * 内核将报文按块（block）写入与用户态共享的环形缓冲区，抓包线程在原地遍历
+ * 每个已就绪块中的所有帧，逐帧交给 packet_handler 处理后再把整块归还内核，
+ * 避免 pcap_next_ex 的逐包系统调用与拷贝开销。
+ */
+
+// 单个块大小（字节），须为页大小的整数倍；fanout 模式下每个抓包线程各占一份环形缓冲区
+constexpr uint32_t RING_BLOCK_SIZE = 1 << 20;
+
+// 环形缓冲区中的块数量
+constexpr uint32_t RING_BLOCK_COUNT = 64;
+
+// 帧大小（字节），TPACKET_V3 下帧为变长，仅用于计算 tp_frame_nr
+constexpr uint32_t RING_FRAME_SIZE = 2048;
+
+// 块超时（毫秒）：块未写满时，内核在该时间后也会将其交给用户态
+constexpr uint32_t RING_BLOCK_TIMEOUT_MS = 60;
+
+// 等待新块时 poll 的超时（毫秒），用于周期性检查退出标志
+constexpr int RING_POLL_TIMEOUT_MS = 200;
+
+/**
+ * @brief fanout 抓包线程的启动同步
+ *
+ * 各成员线程建立套接字、环形缓冲区并加入 fanout 组后调用 arrive 报告结果并等待其余成员；
+ * 任一成员建立失败时所有成员都放弃抓包，避免剩余线程只抓到部分流而无人察觉。
+ */
+class FanoutStartup {
+public:
+    explicit FanoutStartup(size_t members) : pending(members) {}
+
+    /**
+     * @brief 报告本线程的建立结果，阻塞直到所有成员都已报告
+     * @return true 表示所有成员均建立成功，可以开始抓包
+     */
+    bool arrive(bool ok);
+
+    /**
+     * @brief 建立失败的成员数
+     */
+    size_t failures() const;
+
+private:
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    size_t pending;
+    size_t failed = 0;
+};
+
+/**
+ * @brief 使用 TPACKET_V3 环形缓冲区在指定网卡上抓取 DNS 报文
+ *
+ * 需要 CAP_NET_RAW 权限。该函数会阻塞运行直到 stop_processing 被置为 true，
+ * 期间周期性读取 PACKET_STATISTICS 并通过 accumulate_capture_stats 累加。
+ * 每个块内解析出的查询记录先缓存在本线程内，整块处理完后一次性推入 domain_queue。
+ *
+ * @param dev 网卡名称（如 "eth0", "ens33"）
+ * @param fanout_group PACKET_FANOUT 组号（0~65535）；小于 0 表示不加入 fanout 组。
+ *        多个线程使用相同组号时，内核按流哈希将报文分发到各线程的环形缓冲区。
+ * @param startup fanout 成员间的启动同步；非空时建立完成后等待其余成员，任一成员失败则不开始抓包。
+ */
+void start_ring_capture(const std::string& dev, int fanout_group = -1,
+                        FanoutStartup* startup = nullptr);
+
+#endif // RING_CAPTURE_H
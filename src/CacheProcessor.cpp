@@ -3,7 +3,7 @@
  * @brief 实现缓存处理主线程的逻辑，包括处理域名、更新缓存、触发上报等。
  *
  * 本模块是系统核心组件之一，负责从域名队列中取出待处理域名，执行缓存更新、
- * 状态标记和异步上报逻辑。通过线程池加速处理，支持安全终止机制。
+ * 状态标记，并把新域名交给上报阶段。按域名分片（或线程池）并行处理，支持安全终止机制。
  *
  * 使用场景：DNS嗅探器的后端缓存管理线程，连接 Redis 缓存、域名处理队列和上报器。
  */
@@ -11,63 +11,146 @@
 #include <iostream>
 #include <chrono>
 #include <mutex>
+#include <memory>
+#include <vector>
+#include <algorithm>
 
 #include "CacheProcessor.h"
-#include "RedisDNSCache.h"
-#include "ThreadPool.h"
+#include "DomainStore.h"
+#include "WorkStealingPool.h"
+#include "ShardedExecutor.h"
+#include "pipeline_stats.h"
 
 void cache_processor(
-    RedisDNSCache& cache,
-    ThreadSafeQueue<std::string>& domain_queue,
+    DomainStore& cache,
+    DomainQueue& domain_queue,
+    ReportQueue& report_queue,
     std::atomic<bool>& stop_processing,
-    DomainReporter& reporter,
-    ThreadPool& pool
+    CacheExecutorMode mode,
+    size_t worker_count,
+    const Whitelist* whitelist
 ) {
-    std::mutex cache_mutex;  // 保证对 RedisDNSCache 操作的线程安全
+    const bool sharded = (mode == CacheExecutorMode::SHARDED);
+    std::mutex cache_mutex;  // POOL 模式下保证对 DomainStore 操作的线程安全
+    std::atomic<uint64_t> whitelisted{0};
 
-    // 处理单个域名任务
-    auto process_domain = [&](const std::string& domain) {
+    // 处理单个合并事件，命中次数作为一次增量写入
+    auto process_domain = [&](const CoalescedQuery& query, const WhitelistMatcher* matcher) {
         try {
-            std::lock_guard<std::mutex> lock(cache_mutex);
+            StageTimer timer(pipeline_stats.cache_ns);
+            std::string domain(query.record.domain());
 
-            // 查找域名是否已存在
-            auto entry = cache.find(domain);
-            if (!entry) {
-                // 不存在则作为可疑域名加入（默认状态 FAKE + DROP）
-                cache.insertOrUpdate(domain, DomainStatus::FAKE, DomainAction::DROP);
+            // 命中本地白名单：一次写入直接判定为 FULL + PERMIT 并累加访问次数，
+            // 同时移出待上报集合，不经过 FAKE 状态，也不进入上报阶段
+            if (matcher && matcher->matches(domain)) {
+                cache.applyVerdicts({DomainVerdict{domain, DomainStatus::FULL, DomainAction::PERMIT,
+                                                   query.hits}});
+                whitelisted.fetch_add(1, std::memory_order_relaxed);
             } else {
-                // 已存在则更新访问时间或重置 TTL
-                cache.insertOrUpdate(domain, entry->status, entry->action);
-            }
+                // 单次往返：已存在则保持状态/动作并累加访问次数（刷新 TTL），不存在则作为可疑域名
+                // 加入（默认状态 FAKE + DROP）
+                bool inserted = false;
+                auto entry = cache.recordQuery(domain, query.hits, &inserted);
 
-            // 达到阈值触发一次上报
-            if (cache.getPendingReportCount() >= kReportThreshold) {
-                reporter.try_report_domains(cache, kMaxRetryCount, kRetryDelay);
+                // 新域名交给上报阶段（队列满时丢弃，域名仍在待上报集合中，由上报阶段重新同步时补报）
+                if (entry && inserted) {
+                    report_queue.push(query.record);
+                }
             }
         } catch (const std::exception& e) {
             std::cerr << "[worker] error: " << e.what() << std::endl;
         }
+        pipeline_count(pipeline_stats.domains_done, query.hits);
     };
 
-    // 主循环：不断从队列中取出域名处理，直到收到 stop 信号
-    while (!stop_processing.load(std::memory_order_acquire)) {
-        std::string domain;
-        domain_queue.wait_and_pop(domain);  // 阻塞式等待
-        if (domain.empty()) continue;       // 空字符串为“唤醒退出”标志
+    // 处理一批合并事件。
+    // SHARDED 模式下整批域名属于同一分片，由该分片线程独占执行，不加锁；
+    // POOL 模式下整批只加一次全局锁。整批使用同一个白名单快照，名单重新加载不影响正在处理的批次
+    auto process_batch = [&](const std::vector<CoalescedQuery>& batch) {
+        std::shared_ptr<const WhitelistMatcher> matcher;
+        if (whitelist) matcher = whitelist->snapshot();
+
+        std::unique_lock<std::mutex> lock(cache_mutex, std::defer_lock);
+        if (!sharded) lock.lock();
+
+        for (const auto& query : batch) {
+            process_domain(query, matcher.get());
+        }
+    };
 
-        pool.enqueue(process_domain, domain);  // 异步处理域名任务
+    std::unique_ptr<ShardedExecutor> shards;
+    std::unique_ptr<WorkStealingPool> pool;
+    if (sharded) {
+        shards.reset(new ShardedExecutor(worker_count));
+    } else {
+        pool.reset(new WorkStealingPool(worker_count));
     }
+    std::cout << "[cache_processor] " << (sharded ? "sharded executor, " : "thread pool, ")
+              << (sharded ? shards->size() : pool->size()) << " workers\n";
 
-    // 停止前稍作等待，允许线程池中的任务完成
-    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    // 按 kProcessBatchSize 分批提交给执行器，批数据直接移动进任务
+    auto submit_batch = [&](size_t shard, std::vector<CoalescedQuery>&& batch) {
+        auto task = [&process_batch, batch = std::move(batch)] { process_batch(batch); };
+        if (sharded) {
+            shards->submit(shard, std::move(task));
+        } else {
+            pool->submit(std::move(task));
+        }
+    };
 
-    // 执行最后一次域名上报
-    try {
-        std::lock_guard<std::mutex> lock(cache_mutex);
-        reporter.try_report_domains(cache, kMaxRetryCount, kRetryDelay);
-    } catch (const std::exception& e) {
-        std::cerr << "[cache_processor] final reporting failed: " << e.what() << std::endl;
+    // SHARDED 模式下先按域名所属分片分组，每个分片内保持窗口中的先后顺序
+    std::vector<std::vector<CoalescedQuery>> per_shard(sharded ? shards->size() : 1);
+    auto dispatch = [&](std::vector<CoalescedQuery>& events) {
+        for (auto& event : events) {
+            size_t shard = sharded ? shards->shard_for(event.record.domain()) : 0;
+            auto& batch = per_shard[shard];
+            batch.push_back(event);
+            if (batch.size() >= kProcessBatchSize) {
+                submit_batch(shard, std::move(batch));
+                batch = std::vector<CoalescedQuery>();
+            }
+        }
+        for (size_t shard = 0; shard < per_shard.size(); ++shard) {
+            if (!per_shard[shard].empty()) {
+                submit_batch(shard, std::move(per_shard[shard]));
+                per_shard[shard] = std::vector<CoalescedQuery>();
+            }
+        }
+        events.clear();
+    };
+
+    // 主循环：批量取出记录并在窗口内合并重复域名，窗口结束后提交，直到收到 stop 信号
+    DomainCoalescer coalescer(kCoalesceWindow, kCoalesceMaxEntries);
+    std::vector<QueryRecord> records;
+    std::vector<CoalescedQuery> events;
+    records.reserve(kProcessBatchSize);
+
+    while (!stop_processing.load(std::memory_order_acquire)) {
+        auto now = std::chrono::steady_clock::now();
+        domain_queue.pop_bulk(records, kProcessBatchSize, coalescer.deadline(now));
+
+        for (const auto& record : records) {
+            if (!record.empty()) coalescer.add(record);  // 空记录为“唤醒退出”标志
+        }
+        records.clear();
+
+        if (coalescer.due(std::chrono::steady_clock::now())) {
+            coalescer.flush(events);
+            dispatch(events);
+        }
     }
 
+    // 提交最后一个窗口中尚未处理的事件
+    coalescer.flush(events);
+    dispatch(events);
+
+    // 销毁执行器：等待已提交的任务全部执行完毕
+    shards.reset();
+    pool.reset();
+
+    if (whitelist) {
+        std::cout << "[cache_processor] " << whitelisted.load()
+                  << " whitelisted domain updates written as FULL/PERMIT\n";
+    }
     std::cout << "[cache_processor] stopped\n";
 }
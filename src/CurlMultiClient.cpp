@@ -0,0 +1,168 @@
+/**
+ * @file CurlMultiClient.cpp
+ * @brief curl multi HTTP 客户端实现：单个事件循环线程推进所有请求，连接保持复用，easy 句柄池化。
+ */
+
+#include <iostream>
+#include <stdexcept>
+
+#include "CurlMultiClient.h"
+
+namespace {
+
+// 事件循环的最长休眠时间（毫秒），curl_multi_wakeup 可提前唤醒
+constexpr int kPollTimeoutMs = 1000;
+
+size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
+    size_t total = size * nmemb;
+    static_cast<std::string*>(userp)->append(static_cast<char*>(contents), total);
+    return total;
+}
+
+} // namespace
+
+struct CurlMultiClient::Transfer {
+    CURL* easy = nullptr;
+    std::string url;
+    std::string body;                 // CURLOPT_POSTFIELDS 指向此处，须保持到请求完成
+    const curl_slist* headers = nullptr;
+    HttpResponse response;
+    std::promise<HttpResponse> promise;
+};
+
+CurlMultiClient::CurlMultiClient() : multi(curl_multi_init()) {
+    if (!multi) {
+        throw std::runtime_error("[CurlMultiClient] curl_multi_init failed");
+    }
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, HTTP_MAX_HOST_CONNECTIONS);
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, HTTP_MAX_HOST_CONNECTIONS);
+    loop = std::thread(&CurlMultiClient::event_loop, this);
+}
+
+CurlMultiClient::~CurlMultiClient() {
+    stop.store(true);
+    curl_multi_wakeup(multi);
+    if (loop.joinable()) loop.join();
+
+    for (CURL* easy : idle) {
+        curl_easy_cleanup(easy);
+    }
+    curl_multi_cleanup(multi);
+}
+
+CURL* CurlMultiClient::acquire_handle() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!idle.empty()) {
+            CURL* easy = idle.back();
+            idle.pop_back();
+            return easy;
+        }
+    }
+    return curl_easy_init();
+}
+
+void CurlMultiClient::release_handle(CURL* easy) {
+    // 重置选项但保留句柄（连接本身保存在 multi 句柄的连接缓存中）
+    curl_easy_reset(easy);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idle.size() < HTTP_IDLE_HANDLES) {
+            idle.push_back(easy);
+            return;
+        }
+    }
+    curl_easy_cleanup(easy);
+}
+
+std::future<HttpResponse> CurlMultiClient::post(const std::string& url, std::string body,
+                                                const curl_slist* headers) {
+    std::unique_ptr<Transfer> transfer(new Transfer);
+    transfer->url = url;
+    transfer->body = std::move(body);
+    transfer->headers = headers;
+    std::future<HttpResponse> result = transfer->promise.get_future();
+
+    transfer->easy = acquire_handle();
+    if (!transfer->easy) {
+        transfer->response.result = CURLE_FAILED_INIT;
+        transfer->promise.set_value(std::move(transfer->response));
+        return result;
+    }
+
+    CURL* easy = transfer->easy;
+    curl_easy_setopt(easy, CURLOPT_URL, transfer->url.c_str());
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS, transfer->body.c_str());
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, static_cast<long>(transfer->body.size()));
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT, HTTP_TIMEOUT_SEC);
+    curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(easy, CURLOPT_MAXREDIRS, 3L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer->response.body);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer.get());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        submitted.push_back(std::move(transfer));
+    }
+    curl_multi_wakeup(multi);
+    return result;
+}
+
+void CurlMultiClient::event_loop() {
+    std::vector<std::unique_ptr<Transfer>> incoming;
+    size_t active = 0;
+
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            incoming.swap(submitted);
+        }
+        for (auto& transfer : incoming) {
+            if (curl_multi_add_handle(multi, transfer->easy) != CURLM_OK) {
+                transfer->response.result = CURLE_FAILED_INIT;
+                release_handle(transfer->easy);
+                transfer->promise.set_value(std::move(transfer->response));
+                continue;
+            }
+            transfer.release();  // 所有权交给 multi 句柄（通过 CURLOPT_PRIVATE 取回）
+            ++active;
+        }
+        incoming.clear();
+
+        // 退出前完成所有已提交的请求
+        if (active == 0 && stop.load()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (submitted.empty()) break;
+            continue;
+        }
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        int left = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi, &left)) {
+            if (msg->msg != CURLMSG_DONE) continue;
+
+            CURL* easy = msg->easy_handle;
+            Transfer* raw = nullptr;
+            curl_easy_getinfo(easy, CURLINFO_PRIVATE, reinterpret_cast<char**>(&raw));
+            std::unique_ptr<Transfer> transfer(raw);
+
+            transfer->response.result = msg->data.result;
+            curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &transfer->response.status);
+            curl_multi_remove_handle(multi, easy);
+            release_handle(easy);
+            --active;
+
+            transfer->promise.set_value(std::move(transfer->response));
+        }
+
+        if (active > 0 || !stop.load()) {
+            curl_multi_poll(multi, nullptr, 0, kPollTimeoutMs, nullptr);
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#include "DomainCoalescer.h"
+
+DomainCoalescer::DomainCoalescer(std::chrono::milliseconds window, size_t max_entries)
+    : window_(window), max_entries_(max_entries) {
+    index_.reserve(max_entries);
+}
+
+void DomainCoalescer::add(const QueryRecord& record) {
+    if (entries_.empty()) {
+        window_start_ = std::chrono::steady_clock::now();
+    }
+
+    auto it = index_.find(record.domain());
+    if (it != index_.end()) {
+        CoalescedQuery& entry = entries_[it->second];
+        entry.record = record;
+        ++entry.hits;
+        return;
+    }
+
+    entries_.push_back(CoalescedQuery{record, 1});
+    index_.emplace(entries_.back().record.domain(), entries_.size() - 1);
+}
+
+bool DomainCoalescer::due(std::chrono::steady_clock::time_point now) const {
+    if (entries_.empty()) return false;
+    return entries_.size() >= max_entries_ || now - window_start_ >= window_;
+}
+
+std::chrono::steady_clock::time_point DomainCoalescer::deadline(std::chrono::steady_clock::time_point now) const {
+    return entries_.empty() ? now + window_ : window_start_ + window_;
+}
+
+void DomainCoalescer::flush(std::vector<CoalescedQuery>& out) {
+    out.insert(out.end(), entries_.begin(), entries_.end());
+    index_.clear();
+    entries_.clear();
+}
@@ -0,0 +1,236 @@
+/**
+ * @file DomainL1Cache.cpp
+ * @brief 分片开放寻址 L1 域名缓存实现（CLOCK 淘汰 + TTL）
+ */
+
+#include <algorithm>
+#include <functional>
+
+#include "DomainL1Cache.h"
+#include "DomainStore.h"
+
+struct DomainL1Cache::Slot {
+    uint64_t hash = 0;
+    std::string key;
+    Value value{};
+    bool occupied = false;
+    bool referenced = false;  // CLOCK 访问位
+};
+
+struct alignas(64) DomainL1Cache::Shard {
+    mutable std::mutex mutex;
+    std::vector<Slot> slots;
+    size_t mask = 0;
+    size_t count = 0;
+    size_t max_count = 0;
+    size_t hand = 0;          // CLOCK 指针
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t expirations = 0;
+
+    // 线性探测查找，返回槽位下标；未找到返回 slots.size()
+    size_t find(uint64_t hash, std::string_view key) const {
+        size_t i = hash & mask;
+        while (slots[i].occupied) {
+            if (slots[i].hash == hash && slots[i].key == key) return i;
+            i = (i + 1) & mask;
+        }
+        return slots.size();
+    }
+
+    // 删除槽位 i，并把其后同一探测链上的条目前移，保持探测链连续（不使用墓碑）
+    void erase_at(size_t i) {
+        size_t j = i;
+        for (;;) {
+            j = (j + 1) & mask;
+            if (!slots[j].occupied) break;
+            size_t home = slots[j].hash & mask;
+            // home 位于 (i, j] 区间内（环形）时，该条目不能前移到 i
+            bool in_range = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+            if (in_range) continue;
+            slots[i] = std::move(slots[j]);
+            i = j;
+        }
+        slots[i].occupied = false;
+        slots[i].referenced = false;
+        slots[i].key.clear();
+        --count;
+    }
+
+    // CLOCK：跳过并清除访问位为 1 的条目，淘汰第一个访问位为 0 的条目
+    void evict_one() {
+        for (;;) {
+            Slot& slot = slots[hand];
+            if (slot.occupied) {
+                if (slot.referenced) {
+                    slot.referenced = false;
+                } else {
+                    erase_at(hand);  // 后移的条目落在 hand 处，下一轮继续检查
+                    ++evictions;
+                    return;
+                }
+            }
+            hand = (hand + 1) & mask;
+        }
+    }
+};
+
+namespace {
+
+bool is_expired(const DomainL1Cache::Value& value, time_t now) {
+    return static_cast<long long>(value.last_updated) + value.ttl < static_cast<long long>(now);
+}
+
+uint64_t hash_domain(std::string_view domain) {
+    return std::hash<std::string_view>{}(domain);
+}
+
+} // namespace
+
+DomainL1Cache::DomainL1Cache(size_t capacity) : capacity_(capacity) {
+    if (capacity_ == 0) return;
+
+    size_t shard_count = std::min(L1_CACHE_SHARDS, capacity_);
+    size_t per_shard = (capacity_ + shard_count - 1) / shard_count;
+
+    // 槽位数取 2 的幂，且负载因子不超过 0.75
+    size_t slots = 2;
+    while (slots * 3 < per_shard * 4) slots <<= 1;
+
+    for (size_t i = 0; i < shard_count; ++i) {
+        std::unique_ptr<Shard> shard(new Shard);
+        shard->slots.resize(slots);
+        shard->mask = slots - 1;
+        shard->max_count = per_shard;
+        shards_.push_back(std::move(shard));
+    }
+}
+
+DomainL1Cache::~DomainL1Cache() = default;
+
+DomainL1Cache::Shard& DomainL1Cache::shard_for(uint64_t hash) const {
+    // 高位选分片，低位选槽位，避免同一分片内的哈希集中在少数槽位
+    return *shards_[(hash >> 40) % shards_.size()];
+}
+
+bool DomainL1Cache::get(std::string_view domain, time_t now, Value& out) {
+    if (!enabled()) return false;
+
+    uint64_t hash = hash_domain(domain);
+    Shard& shard = shard_for(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    size_t i = shard.find(hash, domain);
+    if (i == shard.slots.size()) {
+        ++shard.misses;
+        return false;
+    }
+
+    Slot& slot = shard.slots[i];
+    if (is_expired(slot.value, now)) {
+        shard.erase_at(i);
+        ++shard.expirations;
+        ++shard.misses;
+        return false;
+    }
+
+    slot.referenced = true;
+    out = slot.value;
+    ++shard.hits;
+    return true;
+}
+
+bool DomainL1Cache::touch(std::string_view domain, time_t now, uint32_t hits, Value& out) {
+    if (!enabled()) return false;
+
+    uint64_t hash = hash_domain(domain);
+    Shard& shard = shard_for(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    size_t i = shard.find(hash, domain);
+    if (i == shard.slots.size()) {
+        ++shard.misses;
+        return false;
+    }
+
+    Slot& slot = shard.slots[i];
+    if (is_expired(slot.value, now)) {
+        shard.erase_at(i);
+        ++shard.expirations;
+        ++shard.misses;
+        return false;
+    }
+
+    slot.value.query_count += hits;
+    slot.value.last_updated = now;
+    slot.value.last_accessed = now;
+    slot.referenced = true;
+    out = slot.value;
+    ++shard.hits;
+    return true;
+}
+
+void DomainL1Cache::put(std::string_view domain, const Value& value) {
+    if (!enabled()) return;
+    if (is_expired(value, std::time(nullptr))) {
+        erase(domain);
+        return;
+    }
+
+    uint64_t hash = hash_domain(domain);
+    Shard& shard = shard_for(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    size_t i = shard.find(hash, domain);
+    if (i != shard.slots.size()) {
+        shard.slots[i].value = value;
+        shard.slots[i].referenced = true;
+        return;
+    }
+
+    if (shard.count >= shard.max_count) {
+        shard.evict_one();
+    }
+
+    i = hash & shard.mask;
+    while (shard.slots[i].occupied) {
+        i = (i + 1) & shard.mask;
+    }
+
+    Slot& slot = shard.slots[i];
+    slot.hash = hash;
+    slot.key.assign(domain.data(), domain.size());
+    slot.value = value;
+    slot.occupied = true;
+    slot.referenced = false;  // 新条目需再次被访问才能躲过一轮淘汰
+    ++shard.count;
+}
+
+void DomainL1Cache::erase(std::string_view domain) {
+    if (!enabled()) return;
+
+    uint64_t hash = hash_domain(domain);
+    Shard& shard = shard_for(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    size_t i = shard.find(hash, domain);
+    if (i != shard.slots.size()) {
+        shard.erase_at(i);
+    }
+}
+
+L1CacheStats DomainL1Cache::stats() const {
+    L1CacheStats total;
+    total.capacity = capacity_;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total.hits += shard->hits;
+        total.misses += shard->misses;
+        total.evictions += shard->evictions;
+        total.expirations += shard->expirations;
+        total.size += shard->count;
+    }
+    return total;
+}
@@ -6,19 +6,20 @@
 #include <thread>
 #include <mutex>
 #include <memory>
-#include "RedisDNSCache.h"
+#include "DomainStore.h"
 
 DomainReporter& DomainReporter::getInstance() {
     static DomainReporter instance;
     return instance;
 }
 
-DomainReporter::DomainReporter() {
+DomainReporter::DomainReporter() : curlInitialized(false), defaultHeaders(nullptr) {
     serverUrl = "http://localhost:8080/hello"; // 默认 URL
 }
 
 DomainReporter::~DomainReporter() {
     if (curlInitialized.load()) {
+        http.reset();  // 等待在途请求完成并关闭连接，须在 curl_global_cleanup 之前
         curl_slist_free_all(defaultHeaders);
         curl_global_cleanup();
     }
@@ -30,112 +31,81 @@ void DomainReporter::setServerUrl(const std::string& url) {
 }
 
 void DomainReporter::initializeCurl() {
-    if (!curlInitialized.load()) {
+    // 多个上报线程可能同时首次调用，curl_global_init 只能执行一次
+    std::call_once(curlInitOnce, [this] {
         curl_global_init(CURL_GLOBAL_ALL);
         defaultHeaders = curl_slist_append(nullptr, "Content-Type: application/json");
         defaultHeaders = curl_slist_append(defaultHeaders, "Accept: application/json");
+        http.reset(new CurlMultiClient());
         curlInitialized.store(true);
-    }
+    });
 }
 
-size_t DomainReporter::writeCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-    size_t totalSize = size * nmemb;
-    std::string* response = static_cast<std::string*>(userp);
-    response->append(static_cast<char*>(contents), totalSize);
-    return totalSize;
-}
+std::future<HttpResponse> DomainReporter::postJson(std::string json_data) {
+    initializeCurl();
 
-// 设置 CURL 请求参数
-void DomainReporter::configureCurl(CURL* curl, const std::string& url, const std::string& json_data, std::string& response_data) {
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, defaultHeaders);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, json_data.size());
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 3L);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);
+    std::string url;
+    {
+        std::lock_guard<std::mutex> lock(urlMutex);
+        url = serverUrl;
+    }
+    return http->post(url, std::move(json_data), defaultHeaders);
 }
 
-bool DomainReporter::reportDomains(RedisDNSCache& cache, const std::vector<std::string>& domains) {
+bool DomainReporter::reportDomains(DomainStore& cache, const std::vector<std::string>& domains) {
     if (domains.empty()) return true;
 
     try {
-        initializeCurl();
-
         // 构造 JSON 数据
         nlohmann::json payload = {
             {"domains", domains},
             {"timestamp", std::time(nullptr)}
         };
-        std::string json_data = payload.dump();
 
-        // 初始化 CURL，RAII 管理
-        struct CurlDeleter {
-            void operator()(CURL* c) const { if (c) curl_easy_cleanup(c); }
-        };
-        std::unique_ptr<CURL, CurlDeleter> curl(curl_easy_init());
-        if (!curl) {
-            std::cerr << "[DomainReporter] Failed to initialize CURL" << std::endl;
+        // 经由共享的 multi 客户端发送（复用持久连接），其他线程的请求同时在途
+        HttpResponse response = postJson(payload.dump()).get();
+        if (response.result != CURLE_OK) {
+            std::cerr << "[DomainReporter] CURL request failed: " << curl_easy_strerror(response.result) << std::endl;
             return false;
         }
 
-        std::string response_data;
-        {
-            std::lock_guard<std::mutex> lock(urlMutex);
-            configureCurl(curl.get(), serverUrl, json_data, response_data);
-        }
-
-        CURLcode res = curl_easy_perform(curl.get());
-        if (res != CURLE_OK) {
-            std::cerr << "[DomainReporter] CURL request failed: " << curl_easy_strerror(res) << std::endl;
-            return false;
-        }
-
-        long response_code = 0;
-        curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &response_code);
+        long response_code = response.status;
+        const std::string& response_data = response.body;
 
         if (response_code < 200 || response_code >= 300) {
             std::cerr << "[DomainReporter] Server returned error code: " << response_code << std::endl;
             return false;
         }
 
-        if(response_code >= 200 && response_code < 300) {
-            // std::cout << "[DomainReporter] Report successful. HTTP " << response_code << std::endl;
-            for (const auto& domain : domains) {
-                std::shared_ptr<RedisDNSCache::DomainEntry> info = cache.find(domain);
-                if (info && info->status == DomainStatus::FAKE) {
-                    cache.insertOrUpdate(domain, DomainStatus::PEND, info->action);
-                    // std::cout << "[DomainReporter] Marked domain as PEND: " << domain << std::endl;
-                }
-            }
-
-            // 尝试解析响应
-            try {
-                nlohmann::json response_json = nlohmann::json::parse(response_data);
-
-                auto handleArray = [&](const std::string& key, DomainAction action) {
-                    if (response_json.contains(key) && response_json[key].is_array()) {
-                        for (const auto& domain : response_json[key]) {
-                            std::string d = domain.get<std::string>();
-                            // std::cout << "[DomainReporter] " << (action == DomainAction::PERMIT ? "PERMIT" : "DROP") << ": " << d << std::endl;
-                            cache.insertOrUpdate(d, DomainStatus::FULL, action);
-                        }
-                    }
-                };
+        // 上报成功：已上报的 FAKE 域名推进为 PEND，服务器给出的判定写为 FULL，整批一次提交
+        std::vector<DomainVerdict> verdicts;
+        verdicts.reserve(domains.size());
+        for (const auto& domain : domains) {
+            verdicts.push_back(DomainVerdict{domain, DomainStatus::PEND, DomainAction::DROP});
+        }
 
-                handleArray("permitted", DomainAction::PERMIT);
-                handleArray("dropped", DomainAction::DROP);
+        // 尝试解析响应
+        bool parsed = true;
+        try {
+            nlohmann::json response_json = nlohmann::json::parse(response_data);
 
-                
-                return true;
+            auto handleArray = [&](const std::string& key, DomainAction action) {
+                if (response_json.contains(key) && response_json[key].is_array()) {
+                    for (const auto& domain : response_json[key]) {
+                        verdicts.push_back(DomainVerdict{domain.get<std::string>(), DomainStatus::FULL, action});
+                    }
+                }
+            };
 
-            } catch (const std::exception& e) {
-                std::cerr << "[DomainReporter] JSON parse error: " << e.what() << std::endl;
-                return false;
-            }
+            handleArray("permitted", DomainAction::PERMIT);
+            handleArray("dropped", DomainAction::DROP);
+        } catch (const std::exception& e) {
+            std::cerr << "[DomainReporter] JSON parse error: " << e.what() << std::endl;
+            parsed = false;
         }
+
+        cache.applyVerdicts(verdicts);
+        return parsed;
     } catch (const std::exception& e) {
         std::cerr << "[DomainReporter] Exception: " << e.what() << std::endl;
         return false;
@@ -145,109 +115,71 @@ bool DomainReporter::reportDomains(RedisDNSCache& cache, const std::vector<std::
     }
 }
 
-void DomainReporter::try_report_domains(
-    RedisDNSCache& cache,
-    size_t max_retries,
-    std::chrono::seconds retry_delay
-) {
-    size_t attempt = 0;
-    bool success = false;
-    std::vector<std::string> domains = cache.getPendingReportDomains();
-    std::vector<std::string> filtered_domains;
-    
-    // 过滤待上报域名，跳过已经ttl超时的域名
-    for(const std::string& domain:domains) {
-        auto entry = cache.find(domain);
-        if(entry) {
-            filtered_domains.push_back(domain);
-        } 
+bool DomainReporter::postStats(const std::string& json_data) {
+    HttpResponse response = postJson(json_data).get();
+    if (response.result != CURLE_OK) {
+        std::cerr << "[DomainReporter] CURL failed: " << curl_easy_strerror(response.result) << "\n";
+        return false;
     }
 
-    if (filtered_domains.empty()) {
-        std::cout << "[DomainReporter] No valid domains to report\n";
-        cache.clearPendingReportDomains();  // 清空 set
+    if (response.status < 200 || response.status >= 300) {
+        std::cerr << "[DomainReporter] Stats report failed, HTTP " << response.status << "\n";
+        return false;
     }
+    return true;
+}
 
-    // 上报逻辑 + 重试机制
-    while (attempt < max_retries && !success) {
-        // std::cout << "[DomainReporter] Reporting " << filtered_domains.size() 
-        //           << " domains (attempt " << (attempt + 1) << ")\n";
-        success = reportDomains(cache, filtered_domains);  // 用 curl 发请求
+void DomainReporter::reportStats(DomainStore& cache, int interval_seconds) {
+    (void)interval_seconds;
 
-        if (!success) {
-            ++attempt;
-            if (attempt < max_retries) {
-                std::this_thread::sleep_for(retry_delay);
-            }
-        }
-    }
+    // 流式遍历缓存，每攒够 kStatsChunkSize 条有访问的域名就发送一次，内存占用与缓存规模无关
+    nlohmann::json chunk = nlohmann::json::array();
+    std::vector<std::string> chunk_domains;
+    size_t reported = 0;
+    bool ok = true;
 
-    if (success) {
-        cache.clearPendingReportDomains();  // 成功上报后清空 set
-    } else {
-        std::cerr << "[DomainReporter] Failed after " << max_retries << " attempts\n";
-    }
+    auto flush = [&]() {
+        if (chunk_domains.empty()) return true;
 
-}
+        nlohmann::json payload = {
+            {"stats", std::move(chunk)},
+            {"timestamp", std::time(nullptr)}
+        };
+        chunk = nlohmann::json::array();
 
-void DomainReporter::reportStats(RedisDNSCache& cache, int interval_seconds) {
-    std::vector<nlohmann::json> report_data;
+        bool sent = postStats(payload.dump());
+        if (sent) {
+            // 清零已上报域名的访问次数
+            cache.resetQueryCounts(chunk_domains);
+            reported += chunk_domains.size();
+        }
+        chunk_domains.clear();
+        return sent;
+    };
 
-    auto all = cache.getAllDomainData();
+    try {
+        cache.forEachDomain([&](const std::string& domain, const DomainStore::DomainMeta& meta) {
+            if (meta.query_count == 0) return true;
 
-    for (const auto& [domain, meta] : all) {
-        if (meta.query_count > 0) {
-            report_data.push_back({
+            chunk.push_back({
                 {"domain", domain},
                 {"action", meta.action == DomainAction::DROP ? "DROP" : "PERMIT"},
                 {"queries", meta.query_count}
             });
-        }
-    }
-
-    // 构造 JSON
-    nlohmann::json payload = {
-        {"stats", report_data},
-        {"timestamp", std::time(nullptr)}
-    };
-
-    std::string json_data = payload.dump();
-    // std::cout << "[DomainReporter] Reporting stats payload:\n" << json_data << "\n";
+            chunk_domains.push_back(domain);
 
-    // curl 上报
-    try {
-        CURL* curl = curl_easy_init();
-
-        if (curl) {
-            std::string response_data;
-            {
-                std::lock_guard<std::mutex> lock(urlMutex);
-                configureCurl(curl, serverUrl, json_data, response_data);
+            if (chunk_domains.size() >= kStatsChunkSize) {
+                ok = flush();
             }
+            return ok;  // 发送失败时停止遍历，未上报的计数留待下一周期
+        });
+        if (ok) ok = flush();
+    } catch (const std::exception& e) {
+        std::cerr << "[DomainReporter] Exception while reporting stats: " << e.what() << "\n";
+        return;
+    }
 
-            CURLcode res = curl_easy_perform(curl);
-
-            if (res == CURLE_OK) {
-                long response_code;
-
-                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-
-                if (response_code >= 200 && response_code < 300) {
-                    std::cout << "[DomainReporter] Stats reported successfully\n";
-                    // 清零访问次数
-                    for (const auto& entry : report_data) {
-                        cache.resetQueryCount(entry["domain"].get<std::string>());
-                    }
-                } else {
-                    std::cerr << "[DomainReporter] Stats report failed, HTTP " << response_code << "\n";
-                }
-            } else {
-                std::cerr << "[DomainReporter] CURL failed: " << curl_easy_strerror(res) << "\n";
-            }
-            curl_easy_cleanup(curl);
-        }
-    } catch (...) {
-        std::cerr << "[DomainReporter] Exception while reporting stats\n";
+    if (ok) {
+        std::cout << "[DomainReporter] Stats reported successfully (" << reported << " domains)\n";
     }
 }
-
@@ -0,0 +1,60 @@
+/**
+ * @file DomainStore.cpp
+ * @brief 域名存储接口中与后端无关的公共实现（TTL 配置与基于虚方法的组合操作）
+ */
+
+#include <algorithm>
+
+#include "DomainStore.h"
+
+void DomainStore::setTTLConfig(int fake, int pend, int full_permit, int full_drop) {
+    ttl_config.fake = fake;
+    ttl_config.pend = pend;
+    ttl_config.full_permit = full_permit;
+    ttl_config.full_drop = full_drop;
+}
+
+int DomainStore::getTTL(DomainStatus status, DomainAction action) const {
+    switch(status) {
+        case DomainStatus::FAKE: return ttl_config.fake;
+        case DomainStatus::PEND: return ttl_config.pend;
+        case DomainStatus::FULL:
+            return (action == DomainAction::PERMIT) ? ttl_config.full_permit : ttl_config.full_drop;
+    }
+    return ttl_config.full_permit;
+}
+
+size_t DomainStore::evictionBatch(size_t max_size) {
+    return std::max<size_t>(2, static_cast<size_t>(max_size * 0.1));
+}
+
+bool DomainStore::insertOrUpdate(const std::string& domain, DomainStatus status, DomainAction action,
+                                 uint32_t hits) {
+    return upsert(domain, status, action, hits) != nullptr;
+}
+
+std::unordered_map<std::string, DomainStore::DomainMeta> DomainStore::getAllDomainData() {
+    std::unordered_map<std::string, DomainMeta> result;
+    forEachDomain([&result](const std::string& domain, const DomainMeta& meta) {
+        result[domain] = meta;
+        return true;
+    });
+    return result;
+}
+
+void DomainStore::resetQueryCount(const std::string& domain) {
+    resetQueryCounts({domain});
+}
+
+bool DomainStore::backfillExpiryIndex(std::string& cursor, size_t /*batch*/) {
+    cursor = "0";
+    return true;
+}
+
+size_t DomainStore::flushQueryCounts() {
+    return 0;
+}
+
+L1CacheStats DomainStore::l1Stats() const {
+    return L1CacheStats{};
+}
@@ -0,0 +1,55 @@
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <condition_variable>
+
+#include "ExpirySweeper.h"
+#include "DomainStore.h"
+
+static std::condition_variable sweeper_cv;
+static std::mutex sweeper_mutex;
+
+void expiry_sweeper(
+    DomainStore& cache,
+    std::atomic<bool>& stop_processing
+) {
+    std::string backfill_cursor = "0";
+    bool backfill_done = false;
+    uint64_t total_removed = 0;
+
+    std::unique_lock<std::mutex> lock(sweeper_mutex);
+    while (!stop_processing.load(std::memory_order_acquire)) {
+        try {
+            // 每个周期补建一批旧条目的过期索引，直到 ZSCAN 游标回到 0
+            if (!backfill_done) {
+                backfill_done = cache.backfillExpiryIndex(backfill_cursor, kSweepBatchSize);
+                if (backfill_done) {
+                    std::cout << "[ExpirySweeper] expiry index backfill complete\n";
+                }
+            }
+
+            // 批量删除到期条目；某批未满说明已无到期条目，本周期结束
+            for (size_t i = 0; i < kSweepMaxBatchesPerTick; ++i) {
+                size_t removed = cache.sweepExpired(kSweepBatchSize);
+                total_removed += removed;
+                if (removed < kSweepBatchSize) break;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[ExpirySweeper] error: " << e.what() << std::endl;
+        }
+
+        // 等待下一个周期或收到退出通知
+        if (sweeper_cv.wait_for(lock, kSweepInterval,
+                                [&stop_processing]() { return stop_processing.load(); })) {
+            break;
+        }
+    }
+
+    std::cout << "[ExpirySweeper] Exiting sweeper thread, removed " << total_removed
+              << " expired entries\n";
+}
+
+void stop_expiry_sweeper() {
+    sweeper_cv.notify_all();
+}
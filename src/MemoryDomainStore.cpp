@@ -0,0 +1,352 @@
+/**
+ * @file MemoryDomainStore.cpp
+ * @brief 进程内域名存储实现（分片加锁，每个分片独立的 LRU 链表与过期索引）
+ */
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+#include "MemoryDomainStore.h"
+
+namespace {
+
+struct Node {
+    DomainStatus status;
+    DomainAction action;
+    uint32_t query_count;
+    time_t last_updated;
+    time_t last_accessed;
+    int ttl;
+    std::list<std::string>::iterator lru;                   // 在分片 LRU 链表中的位置
+    std::multimap<long long, std::string>::iterator expiry; // 在分片过期索引中的位置
+};
+
+bool is_expired(const Node& node, time_t now) {
+    return static_cast<long long>(node.last_updated) + node.ttl < static_cast<long long>(now);
+}
+
+std::shared_ptr<DomainStore::DomainEntry> make_entry(const std::string& domain, const Node& node) {
+    return std::make_shared<DomainStore::DomainEntry>(DomainStore::DomainEntry{
+        domain, node.status, node.action, node.query_count,
+        node.last_updated, node.last_accessed});
+}
+
+} // namespace
+
+struct alignas(64) MemoryDomainStore::Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string, Node> entries;
+    std::list<std::string> lru;                     // 表头为最近更新的域名
+    std::multimap<long long, std::string> expiry;   // 绝对过期时间 → 域名
+    size_t max_count = 0;
+
+    using Iterator = std::unordered_map<std::string, Node>::iterator;
+
+    void erase(Iterator it) {
+        lru.erase(it->second.lru);
+        expiry.erase(it->second.expiry);
+        entries.erase(it);
+    }
+
+    // 查找未过期的条目，已过期的条目顺便删除；未找到返回 entries.end()
+    Iterator find_live(const std::string& domain, time_t now) {
+        auto it = entries.find(domain);
+        if (it != entries.end() && is_expired(it->second, now)) {
+            erase(it);
+            return entries.end();
+        }
+        return it;
+    }
+
+    // 插入新条目（分片已满时先淘汰最久未更新的一批条目），字段由 store 填写
+    Iterator insert(const std::string& domain, time_t now) {
+        if (entries.size() >= max_count) {
+            size_t remove_count = evictionBatch(max_count);
+            while (remove_count-- > 0 && !lru.empty()) {
+                erase(entries.find(lru.back()));
+            }
+        }
+
+        auto it = entries.emplace(domain, Node{}).first;
+        lru.push_front(domain);
+        it->second.lru = lru.begin();
+        it->second.expiry = expiry.emplace(now, domain);
+        return it;
+    }
+
+    // 写入条目并刷新 LRU 位置与过期索引
+    void store(Iterator it, DomainStatus status, DomainAction action, uint32_t count,
+               time_t now, int ttl) {
+        Node& node = it->second;
+        node.status = status;
+        node.action = action;
+        node.query_count = count;
+        node.last_updated = now;
+        node.last_accessed = now;
+        node.ttl = ttl;
+
+        lru.splice(lru.begin(), lru, node.lru);
+        expiry.erase(node.expiry);
+        node.expiry = expiry.emplace(static_cast<long long>(now) + ttl, it->first);
+    }
+};
+
+MemoryDomainStore::MemoryDomainStore(size_t max_size) : max_size(std::max<size_t>(max_size, 1)) {
+    // 每个分片至少容纳 MEMORY_STORE_MIN_SHARD_ENTRIES 条，避免小容量下同一分片内的域名互相淘汰
+    size_t shard_count = std::clamp<size_t>(this->max_size / MEMORY_STORE_MIN_SHARD_ENTRIES,
+                                            1, MEMORY_STORE_SHARDS);
+    size_t per_shard = (this->max_size + shard_count - 1) / shard_count;
+
+    for (size_t i = 0; i < shard_count; ++i) {
+        std::unique_ptr<Shard> shard(new Shard);
+        shard->max_count = per_shard;
+        shards.push_back(std::move(shard));
+    }
+}
+
+MemoryDomainStore::~MemoryDomainStore() = default;
+
+MemoryDomainStore::Shard& MemoryDomainStore::shard_for(const std::string& domain) const {
+    return *shards[std::hash<std::string>{}(domain) % shards.size()];
+}
+
+std::shared_ptr<MemoryDomainStore::DomainEntry> MemoryDomainStore::runUpsert(
+    const std::string& domain, DomainStatus status, DomainAction action, uint32_t hits,
+    bool keep_existing, bool* inserted) {
+    time_t now = std::time(nullptr);
+    Shard& shard = shard_for(domain);
+    std::shared_ptr<DomainEntry> entry;
+    bool is_new = false;
+    int ttl = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.find_live(domain, now);
+
+        uint32_t count = hits;
+        if (it != shard.entries.end()) {
+            Node& node = it->second;
+            count = node.query_count;
+            if (keep_existing) {
+                status = node.status;
+                action = node.action;
+            }
+            if (node.status == status) count += hits;
+        } else {
+            it = shard.insert(domain, now);
+            is_new = true;
+
+            std::lock_guard<std::mutex> pending_lock(pending_mutex);
+            pending_report.insert(domain);
+        }
+
+        ttl = getTTL(status, action);
+        shard.store(it, status, action, count, now, ttl);
+        entry = make_entry(domain, it->second);
+    }
+
+    std::cout << "[MemoryStore] " << (is_new ? "Adding" : "Updating") << " domain: " << domain
+              << " (Status: " << statusToString(entry->status)
+              << ", Action: " << actionToString(entry->action)
+              << ", TTL: " << ttl << "s)" << std::endl;
+
+    if (inserted) *inserted = is_new;
+    return entry;
+}
+
+std::shared_ptr<MemoryDomainStore::DomainEntry> MemoryDomainStore::upsert(
+    const std::string& domain, DomainStatus status, DomainAction action, uint32_t hits, bool* inserted) {
+    return runUpsert(domain, status, action, hits, false, inserted);
+}
+
+std::shared_ptr<MemoryDomainStore::DomainEntry> MemoryDomainStore::recordQuery(
+    const std::string& domain, uint32_t hits, bool* inserted) {
+    return runUpsert(domain, DomainStatus::FAKE, DomainAction::DROP, hits, true, inserted);
+}
+
+size_t MemoryDomainStore::applyVerdicts(const std::vector<DomainVerdict>& verdicts) {
+    time_t now = std::time(nullptr);
+    size_t applied = 0;
+
+    for (const auto& verdict : verdicts) {
+        Shard& shard = shard_for(verdict.domain);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.find_live(verdict.domain, now);
+        DomainAction action = verdict.action;
+        if (verdict.status == DomainStatus::PEND) {
+            // 只把尚未上报过的 FAKE 条目推进为 PEND，不插入新条目
+            if (it == shard.entries.end() || it->second.status != DomainStatus::FAKE) continue;
+            action = it->second.action;
+        }
+
+        uint32_t count = verdict.hits;
+        if (it != shard.entries.end()) {
+            count += it->second.query_count;
+        } else {
+            it = shard.insert(verdict.domain, now);
+        }
+        shard.store(it, verdict.status, action, count, now, getTTL(verdict.status, action));
+        ++applied;
+
+        // 已有最终判定，无需再上报
+        if (verdict.status == DomainStatus::FULL) {
+            std::lock_guard<std::mutex> pending_lock(pending_mutex);
+            pending_report.erase(verdict.domain);
+        }
+    }
+    return applied;
+}
+
+std::shared_ptr<MemoryDomainStore::DomainEntry> MemoryDomainStore::find(const std::string& domain) {
+    Shard& shard = shard_for(domain);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.find_live(domain, std::time(nullptr));
+    if (it == shard.entries.end()) return nullptr;
+    return make_entry(domain, it->second);
+}
+
+bool MemoryDomainStore::remove(const std::string& domain) {
+    std::cout << "[MemoryStore] Removing domain: " << domain << std::endl;
+
+    Shard& shard = shard_for(domain);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(domain);
+    if (it != shard.entries.end()) {
+        shard.erase(it);
+    }
+    return true;
+}
+
+size_t MemoryDomainStore::size() {
+    size_t total = 0;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->entries.size();
+    }
+    return total;
+}
+
+void MemoryDomainStore::printAllData() {
+    std::cout << "\n=== Current In-Memory DNS Cache Contents ===\n";
+
+    std::cout << std::left << std::setw(50) << "Domain"
+              << std::setw(10) << "Status"
+              << std::setw(10) << "Action"
+              << std::setw(10) << "Queries"
+              << std::setw(20) << "Last Updated"
+              << std::setw(20) << "Last Accessed"
+              << std::setw(10) << "TTL"
+              << std::endl;
+    std::cout << std::string(130, '-') << std::endl;
+
+    size_t total = 0;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& item : shard->entries) {
+            const Node& node = item.second;
+            std::cout << std::left << std::setw(50) << item.first
+                      << std::setw(10) << statusToString(node.status)
+                      << std::setw(10) << actionToString(node.action)
+                      << std::setw(10) << node.query_count
+                      << std::setw(20) << node.last_updated
+                      << std::setw(20) << node.last_accessed
+                      << std::setw(10) << node.ttl
+                      << std::endl;
+            ++total;
+        }
+    }
+    std::cout << "=== Total entries: " << total << " ===\n\n";
+
+    std::cout << "\n=== Domains in Pending Report Set ===\n";
+    std::vector<std::string> pending = getPendingReportDomains();
+    if (pending.empty()) {
+        std::cout << "(empty set)\n";
+    }
+    for (const auto& domain : pending) {
+        std::cout << "- " << domain << std::endl;
+    }
+    std::cout << "===Total entries: " << pending.size() << " ===\n\n";
+}
+
+void MemoryDomainStore::addToPendingReportSet(const std::string& domain) {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    pending_report.insert(domain);
+}
+
+std::vector<std::string> MemoryDomainStore::getPendingReportDomains() {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    return std::vector<std::string>(pending_report.begin(), pending_report.end());
+}
+
+int MemoryDomainStore::getPendingReportCount() {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    return static_cast<int>(pending_report.size());
+}
+
+void MemoryDomainStore::clearPendingReportDomains() {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    pending_report.clear();
+}
+
+void MemoryDomainStore::removePendingReportDomains(const std::vector<std::string>& domains) {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    for (const auto& domain : domains) {
+        pending_report.erase(domain);
+    }
+}
+
+void MemoryDomainStore::forEachDomain(
+    const std::function<bool(const std::string&, const DomainMeta&)>& visit) {
+    std::vector<std::pair<std::string, DomainMeta>> snapshot;
+
+    for (auto& shard : shards) {
+        // 只在复制时持有分片锁，回调（可能再次访问本存储）在锁外执行
+        snapshot.clear();
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            time_t now = std::time(nullptr);
+            snapshot.reserve(shard->entries.size());
+            for (const auto& item : shard->entries) {
+                const Node& node = item.second;
+                if (is_expired(node, now)) continue;
+                snapshot.emplace_back(item.first, DomainMeta{node.status, node.action, node.query_count});
+            }
+        }
+
+        for (const auto& item : snapshot) {
+            if (!visit(item.first, item.second)) return;
+        }
+    }
+}
+
+void MemoryDomainStore::resetQueryCounts(const std::vector<std::string>& domains) {
+    for (const auto& domain : domains) {
+        Shard& shard = shard_for(domain);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(domain);
+        if (it != shard.entries.end()) {
+            it->second.query_count = 0;
+        }
+    }
+}
+
+size_t MemoryDomainStore::sweepExpired(size_t max_batch) {
+    long long now = static_cast<long long>(std::time(nullptr));
+    size_t removed = 0;
+    size_t start = sweep_start.fetch_add(1, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < shards.size() && removed < max_batch; ++i) {
+        Shard& shard = *shards[(start + i) % shards.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        while (removed < max_batch && !shard.expiry.empty() && shard.expiry.begin()->first < now) {
+            shard.erase(shard.entries.find(shard.expiry.begin()->second));
+            ++removed;
+        }
+    }
+    return removed;
+}
@@ -0,0 +1,41 @@
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+
+#include "QueryCountFlusher.h"
+#include "DomainStore.h"
+
+static std::condition_variable flusher_cv;
+static std::mutex flusher_mutex;
+
+void query_count_flusher(
+    DomainStore& cache,
+    std::atomic<bool>& stop_processing,
+    std::chrono::milliseconds interval
+) {
+    uint64_t total_flushed = 0;
+
+    std::unique_lock<std::mutex> lock(flusher_mutex);
+    while (!stop_processing.load(std::memory_order_acquire)) {
+        // 等待下一个周期或收到退出通知
+        if (flusher_cv.wait_for(lock, interval,
+                                [&stop_processing]() { return stop_processing.load(); })) {
+            break;
+        }
+
+        try {
+            total_flushed += cache.flushQueryCounts();
+        } catch (const std::exception& e) {
+            std::cerr << "[QueryCountFlusher] error: " << e.what() << std::endl;
+        }
+    }
+
+    // 缓存阶段可能仍在处理最后一批记录，剩余增量由 RedisDNSCache 析构时写回
+    std::cout << "[QueryCountFlusher] Exiting flusher thread, flushed " << total_flushed
+              << " domain updates\n";
+}
+
+void stop_query_count_flusher() {
+    flusher_cv.notify_all();
+}
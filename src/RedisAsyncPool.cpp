@@ -0,0 +1,417 @@
+/**
+ * @file RedisAsyncPool.cpp
+ * @brief Redis 异步连接池实现：每个连接一个 epoll 事件循环线程，命令自动流水线，断线自动重连。
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "RedisAsyncPool.h"
+#include "RedisDNSCache.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 退出时等待在途命令完成的最长时间
+constexpr auto kStopTimeout = std::chrono::seconds(2);
+
+// 事件循环的最长休眠时间（毫秒），用于检查退出与重连
+constexpr int kLoopTimeoutMs = 100;
+
+/**
+ * hiredis 在回调返回后释放回复对象，因此需要深拷贝一份交给调用方。
+ * 拷贝与 hiredis 使用相同的分配方式（malloc），可直接用 freeReplyObject 释放。
+ */
+redisReply* copy_reply(const redisReply* src) {
+    if (!src) return nullptr;
+
+    redisReply* dst = static_cast<redisReply*>(std::malloc(sizeof(redisReply)));
+    if (!dst) return nullptr;
+    *dst = *src;
+    dst->str = nullptr;
+    dst->element = nullptr;
+
+    if (src->str) {
+        dst->str = static_cast<char*>(std::malloc(src->len + 1));
+        if (dst->str) {
+            std::memcpy(dst->str, src->str, src->len);
+            dst->str[src->len] = '\0';
+        } else {
+            dst->len = 0;
+        }
+    }
+    if (src->element && src->elements > 0) {
+        dst->element = static_cast<redisReply**>(std::calloc(src->elements, sizeof(redisReply*)));
+        if (dst->element) {
+            for (size_t i = 0; i < src->elements; ++i) {
+                dst->element[i] = copy_reply(src->element[i]);
+            }
+        } else {
+            dst->elements = 0;
+        }
+    }
+    return dst;
+}
+
+} // namespace
+
+struct RedisAsyncPool::Request {
+    std::promise<RedisReplyPtr> promise;
+    char* cmd = nullptr;   // 已格式化的 RESP 命令（redisFreeCommand 释放）
+    size_t len = 0;
+
+    ~Request() { if (cmd) redisFreeCommand(cmd); }
+
+    void fail() { promise.set_value(nullptr); }
+};
+
+struct alignas(64) RedisAsyncPool::Connection {
+    size_t index = 0;
+    int epoll_fd = -1;
+    int event_fd = -1;            // 提交队列非空时唤醒事件循环
+    std::thread worker;
+
+    std::mutex mutex;
+    std::vector<Request*> submitted;   // 等待写入连接的请求
+    std::atomic<bool> up{false};       // 连接是否可用（供提交方选择连接）
+
+    // 以下成员只在事件循环线程中访问
+    redisAsyncContext* ac = nullptr;
+    int fd = -1;
+    bool reading = false;
+    bool writing = false;
+    bool registered = false;
+    bool closing = false;              // 退出时主动释放上下文
+    size_t outstanding = 0;            // 已写入上下文、尚未收到回复的命令数
+    Clock::time_point reconnect_at{};
+    Clock::duration reconnect_delay = REDIS_RECONNECT_DELAY;
+
+    // ---------- hiredis 事件适配（epoll） ----------
+
+    void update_events() {
+        uint32_t events = (reading ? EPOLLIN : 0u) | (writing ? EPOLLOUT : 0u);
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        if (!registered) {
+            if (events == 0) return;
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+            registered = true;
+        } else if (events == 0) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            registered = false;
+        } else {
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+        }
+    }
+
+    static void add_read(void* data) {
+        auto* c = static_cast<Connection*>(data);
+        c->reading = true;
+        c->update_events();
+    }
+    static void del_read(void* data) {
+        auto* c = static_cast<Connection*>(data);
+        c->reading = false;
+        c->update_events();
+    }
+    static void add_write(void* data) {
+        auto* c = static_cast<Connection*>(data);
+        c->writing = true;
+        c->update_events();
+    }
+    static void del_write(void* data) {
+        auto* c = static_cast<Connection*>(data);
+        c->writing = false;
+        c->update_events();
+    }
+    static void cleanup(void* data) {
+        auto* c = static_cast<Connection*>(data);
+        c->reading = c->writing = false;
+        c->update_events();
+    }
+
+    // ---------- 连接管理 ----------
+
+    void schedule_reconnect() {
+        ac = nullptr;
+        fd = -1;
+        registered = false;
+        up.store(false);
+        reconnect_at = Clock::now() + reconnect_delay;
+        reconnect_delay = std::min<Clock::duration>(reconnect_delay * 2, REDIS_RECONNECT_DELAY_MAX);
+    }
+
+    void connect() {
+        redisAsyncContext* ctx = redisAsyncConnect(REDIS_HOST, REDIS_PORT);
+        if (!ctx) {
+            std::cerr << "[RedisAsyncPool] connection " << index << " allocation failed" << std::endl;
+            schedule_reconnect();
+            return;
+        }
+        if (ctx->err) {
+            std::cerr << "[RedisAsyncPool] connection " << index << " failed: "
+                      << (ctx->errstr ? ctx->errstr : "Unknown error") << std::endl;
+            redisAsyncFree(ctx);
+            schedule_reconnect();
+            return;
+        }
+
+        ac = ctx;
+        fd = ctx->c.fd;
+        ctx->data = this;
+        ctx->ev.data = this;
+        ctx->ev.addRead = add_read;
+        ctx->ev.delRead = del_read;
+        ctx->ev.addWrite = add_write;
+        ctx->ev.delWrite = del_write;
+        ctx->ev.cleanup = cleanup;
+        redisAsyncSetConnectCallback(ctx, on_connect);
+        redisAsyncSetDisconnectCallback(ctx, on_disconnect);
+
+        // AUTH 排在所有命令之前发送（连接建立前写入的命令由 hiredis 缓存）
+        redisAsyncCommand(ctx, on_auth, this, "AUTH %s", REDIS_PASSWORD);
+        up.store(true);
+    }
+
+    static void on_connect(const redisAsyncContext* ctx, int status) {
+        auto* c = static_cast<Connection*>(ctx->data);
+        if (status != REDIS_OK) {
+            // 连接失败后 hiredis 会释放上下文
+            std::cerr << "[RedisAsyncPool] connection " << c->index << " failed: "
+                      << (ctx->errstr ? ctx->errstr : "Unknown error") << std::endl;
+            c->schedule_reconnect();
+            return;
+        }
+        c->reconnect_delay = REDIS_RECONNECT_DELAY;
+    }
+
+    static void on_disconnect(const redisAsyncContext* ctx, int status) {
+        auto* c = static_cast<Connection*>(ctx->data);
+        if (status != REDIS_OK && !c->closing) {
+            std::cerr << "[RedisAsyncPool] connection " << c->index << " lost: "
+                      << (ctx->errstr ? ctx->errstr : "Unknown error") << std::endl;
+        }
+        c->schedule_reconnect();
+    }
+
+    static void on_auth(redisAsyncContext*, void* r, void* data) {
+        auto* c = static_cast<Connection*>(data);
+        auto* reply = static_cast<redisReply*>(r);
+        if (!reply) return;  // 断线，由 on_disconnect 处理
+        if (reply->type == REDIS_REPLY_ERROR) {
+            std::cerr << "[RedisAsyncPool] connection " << c->index << " authentication failed: "
+                      << (reply->str ? reply->str : "No error message") << std::endl;
+        } else {
+            std::cout << "[RedisAsyncPool] connection " << c->index
+                      << " authenticated successfully" << std::endl;
+        }
+    }
+
+    static void on_reply(redisAsyncContext* ctx, void* r, void* data) {
+        auto* c = static_cast<Connection*>(ctx->data);
+        --c->outstanding;
+        std::unique_ptr<Request> req(static_cast<Request*>(data));
+        req->promise.set_value(RedisReplyPtr(copy_reply(static_cast<redisReply*>(r))));
+    }
+};
+
+RedisAsyncPool::RedisAsyncPool(size_t connection_count) {
+    if (connection_count == 0) connection_count = 1;
+
+    for (size_t i = 0; i < connection_count; ++i) {
+        std::unique_ptr<Connection> conn(new Connection);
+        conn->index = i;
+        conn->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        conn->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (conn->epoll_fd < 0 || conn->event_fd < 0) {
+            if (conn->epoll_fd >= 0) close(conn->epoll_fd);
+            if (conn->event_fd >= 0) close(conn->event_fd);
+            throw std::runtime_error("[RedisAsyncPool] epoll/eventfd creation failed");
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = conn->event_fd;
+        epoll_ctl(conn->epoll_fd, EPOLL_CTL_ADD, conn->event_fd, &ev);
+        connections.push_back(std::move(conn));
+    }
+    for (auto& conn : connections) {
+        Connection* c = conn.get();
+        c->worker = std::thread([this, c] { event_loop(*c); });
+    }
+}
+
+RedisAsyncPool::~RedisAsyncPool() {
+    stop = true;
+    for (auto& conn : connections) {
+        uint64_t one = 1;
+        ssize_t n = write(conn->event_fd, &one, sizeof(one));
+        (void)n;
+    }
+    for (auto& conn : connections) {
+        if (conn->worker.joinable()) conn->worker.join();
+        close(conn->epoll_fd);
+        close(conn->event_fd);
+    }
+}
+
+std::future<RedisReplyPtr> RedisAsyncPool::commandAsync(const char* format, ...) {
+    va_list ap;
+    va_start(ap, format);
+    auto future = vcommandAsync(format, ap);
+    va_end(ap);
+    return future;
+}
+
+std::future<RedisReplyPtr> RedisAsyncPool::vcommandAsync(const char* format, va_list ap) {
+    char* cmd = nullptr;
+    int len = redisvFormatCommand(&cmd, format, ap);
+    return submit(len < 0 ? nullptr : cmd, len);
+}
+
+std::future<RedisReplyPtr> RedisAsyncPool::commandArgvAsync(int argc, const char** argv,
+                                                           const size_t* argvlen) {
+    char* cmd = nullptr;
+    long long len = redisFormatCommandArgv(&cmd, argc, argv, argvlen);
+    return submit(len < 0 ? nullptr : cmd, len);
+}
+
+redisReply* RedisAsyncPool::command(const char* format, ...) {
+    va_list ap;
+    va_start(ap, format);
+    auto future = vcommandAsync(format, ap);
+    va_end(ap);
+    return future.get().release();
+}
+
+redisReply* RedisAsyncPool::vcommand(const char* format, va_list ap) {
+    return vcommandAsync(format, ap).get().release();
+}
+
+redisReply* RedisAsyncPool::commandArgv(int argc, const char** argv, const size_t* argvlen) {
+    return commandArgvAsync(argc, argv, argvlen).get().release();
+}
+
+std::future<RedisReplyPtr> RedisAsyncPool::submit(char* cmd, long long len) {
+    std::unique_ptr<Request> req(new Request);
+    auto future = req->promise.get_future();
+    if (!cmd) {
+        req->fail();
+        return future;
+    }
+    req->cmd = cmd;
+    req->len = static_cast<size_t>(len);
+
+    // 每个线程固定使用一个“主”连接，保证同一线程提交的命令按顺序执行；主连接断线时改用下一个可用连接
+    thread_local size_t home = next.fetch_add(1, std::memory_order_relaxed);
+    size_t n = connections.size();
+    Connection* target = connections[home % n].get();
+    for (size_t i = 0; i < n; ++i) {
+        Connection* c = connections[(home + i) % n].get();
+        if (c->up.load(std::memory_order_relaxed)) {
+            target = c;
+            break;
+        }
+    }
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(target->mutex);
+        wake = target->submitted.empty();  // 队列非空时事件循环已被唤醒过，无需重复写 eventfd
+        target->submitted.push_back(req.release());
+    }
+    if (wake) {
+        uint64_t one = 1;
+        ssize_t written = write(target->event_fd, &one, sizeof(one));
+        (void)written;
+    }
+    return future;
+}
+
+// 事件循环：写出提交队列中的命令，处理套接字读写事件，断线后按退避间隔重连
+void RedisAsyncPool::event_loop(Connection& conn) {
+    std::vector<Request*> batch;
+    epoll_event events[16];
+    Clock::time_point stop_deadline{};
+    bool stopping = false;
+
+    for (;;) {
+        if (!stopping && stop.load()) {
+            stopping = true;
+            stop_deadline = Clock::now() + kStopTimeout;
+        }
+
+        if (!conn.ac && !stopping && Clock::now() >= conn.reconnect_at) {
+            conn.connect();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(conn.mutex);
+            batch.swap(conn.submitted);
+        }
+        // 一次取走的命令全部追加到输出缓冲区，由一次写事件批量发送（流水线）
+        for (Request* req : batch) {
+            if (conn.ac && redisAsyncFormattedCommand(conn.ac, Connection::on_reply, req,
+                                                      req->cmd, req->len) == REDIS_OK) {
+                ++conn.outstanding;
+                redisFreeCommand(req->cmd);  // hiredis 已复制到输出缓冲区
+                req->cmd = nullptr;
+            } else {
+                req->fail();
+                delete req;
+            }
+        }
+        batch.clear();
+
+        if (stopping && (conn.outstanding == 0 || Clock::now() >= stop_deadline)) {
+            std::lock_guard<std::mutex> lock(conn.mutex);
+            if (conn.submitted.empty() || Clock::now() >= stop_deadline) break;
+        }
+
+        int timeout = kLoopTimeoutMs;
+        if (!conn.ac && !stopping) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                conn.reconnect_at - Clock::now()).count();
+            timeout = static_cast<int>(std::max<long long>(0, std::min<long long>(wait, kLoopTimeoutMs)));
+        }
+
+        int n = epoll_wait(conn.epoll_fd, events, 16, timeout);
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.fd == conn.event_fd) {
+                uint64_t value;
+                ssize_t r = read(conn.event_fd, &value, sizeof(value));
+                (void)r;
+                continue;
+            }
+            if (!conn.ac || events[i].data.fd != conn.fd) continue;
+            if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+                redisAsyncHandleRead(conn.ac);
+            }
+            // 读处理可能因断线释放上下文
+            if (conn.ac && (events[i].events & EPOLLOUT)) {
+                redisAsyncHandleWrite(conn.ac);
+            }
+        }
+    }
+
+    // 释放上下文：尚未收到回复的命令以空回复完成
+    if (conn.ac) {
+        conn.closing = true;
+        redisAsyncFree(conn.ac);
+        conn.ac = nullptr;
+        conn.up.store(false);
+    }
+    std::lock_guard<std::mutex> lock(conn.mutex);
+    for (Request* req : conn.submitted) {
+        req->fail();
+        delete req;
+    }
+    conn.submitted.clear();
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <algorithm>
 #include <vector>
 #include <chrono>
 #include <stdexcept>
@@ -6,72 +7,286 @@
 #include <iomanip>
 #include <stdexcept>
 #include <cstdarg>
+#include <cstring>
+#include <ctime>
 #include <optional>
+#include <future>
 #include <unordered_map>
 
 #include "RedisDNSCache.h"
 
-RedisDNSCache::RedisDNSCache(size_t max_size) 
-    : max_size(max_size) {
+namespace {
+
+/*
+ * 紧凑编码（EntryEncoding::PACKED）：dns:entries:<domain> 为 17 字节字符串，整数均为小端序
+ *   [0]      标志：bit0-1 status，bit2 action，bit4-7 格式版本（当前为 1）
+ *   [1..4]   query_count（uint32）
+ *   [5..8]   last_updated（uint32，Unix 秒）
+ *   [9..12]  last_accessed（uint32，Unix 秒）
+ *   [13..16] ttl（uint32，秒）
+ * 域名只出现在键名中，不再重复存储。
+ */
+constexpr size_t kPackedEntrySize = 17;
+constexpr uint8_t kPackedVersion = 1;
+
+uint32_t get_u32(const char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+    return v;
 }
 
-RedisDNSCache::~RedisDNSCache() {
-
+/*
+ * 各 Lua 脚本共用的条目读写函数，同时识别两种编码（迁移进行中两种格式可能并存）：
+ *   load_entry(key) → {status, action, query_count, last_updated, last_accessed, ttl}, TYPE
+ *   store_entry(key, domain, packed, type, entry) 按 packed 选择编码写入，格式改变时先删除旧值
+ * 旧哈希缺少 last_updated / ttl 字段时对应值为 nil。
+ */
+const char* ENTRY_LUA =
+    "local function load_entry(key)\n"
+    "  local t = redis.call('TYPE', key).ok\n"
+    "  if t == 'string' then\n"
+    "    local flags, count, updated, accessed, ttl = struct.unpack('<BI4I4I4I4', redis.call('GET', key))\n"
+    "    return {flags % 4, math.floor(flags / 4) % 2, count, updated, accessed, ttl}, t\n"
+    "  elseif t == 'hash' then\n"
+    "    local f = redis.call('HMGET', key, 'status', 'action', 'query_count', 'last_updated', 'last_accessed', 'ttl')\n"
+    "    if not f[1] then return nil, t end\n"
+    "    return {tonumber(f[1]), tonumber(f[2]), tonumber(f[3]) or 0, tonumber(f[4]),\n"
+    "            tonumber(f[5]), tonumber(f[6])}, t\n"
+    "  end\n"
+    "  return nil, t\n"
+    "end\n"
+    "local function store_entry(key, domain, packed, t, e)\n"
+    "  local updated = e[4] or 0\n"
+    "  local accessed = e[5] or updated\n"
+    "  local ttl = e[6] or 0\n"
+    "  if packed then\n"
+    "    if t == 'hash' then redis.call('DEL', key) end\n"
+    "    redis.call('SET', key, struct.pack('<BI4I4I4I4', 16 + e[1] + e[2] * 4, e[3], updated, accessed, ttl))\n"
+    "  else\n"
+    "    if t == 'string' then redis.call('DEL', key) end\n"
+    "    redis.call('HMSET', key, 'domain', domain, 'status', e[1], 'action', e[2],\n"
+    "      'last_updated', updated, 'last_accessed', accessed, 'query_count', e[3], 'ttl', ttl)\n"
+    "  end\n"
+    "end\n";
+
+long long field_to_ll(const redisReply* value) {
+    return value->str ? std::strtoll(value->str, nullptr, 10) : 0;
 }
 
-redisContext* RedisDNSCache::getConnection() {
-    thread_local redisContext* conn = nullptr;
+// 解码 GET（紧凑编码）或 HGETALL（哈希编码）的回复；条目不存在或格式不符时返回 false
+bool decode_entry(const redisReply* reply, DomainL1Cache::Value& out) {
+    if (!reply) return false;
+
+    if (reply->type == REDIS_REPLY_STRING) {
+        if (reply->len != kPackedEntrySize) return false;
+        const char* p = reply->str;
+        uint8_t flags = static_cast<uint8_t>(p[0]);
+        if ((flags >> 4) != kPackedVersion) return false;
+        out.status = static_cast<DomainStatus>(flags & 0x3);
+        out.action = static_cast<DomainAction>((flags >> 2) & 0x1);
+        out.query_count = get_u32(p + 1);
+        out.last_updated = static_cast<time_t>(get_u32(p + 5));
+        out.last_accessed = static_cast<time_t>(get_u32(p + 9));
+        out.ttl = static_cast<int>(get_u32(p + 13));
+        return true;
+    }
 
-    if (!conn || conn->err) {
-        if (conn) {
-            std::cerr << "[Redis] Closing broken connection: "
-                      << (conn->errstr ? conn->errstr : "Unknown error") << std::endl;
-            redisFree(conn);
-            conn = nullptr;
+    if (reply->type != REDIS_REPLY_ARRAY || reply->elements == 0) return false;
+
+    // 缺少 ttl 的旧条目 ttl 记为 0（不写入 L1）
+    bool has_status = false, has_action = false;
+    out = DomainL1Cache::Value{DomainStatus::FAKE, DomainAction::DROP, 0, 0, 0, 0};
+    for (size_t i = 0; i + 1 < reply->elements; i += 2) {
+        const redisReply* key = reply->element[i];
+        const redisReply* value = reply->element[i + 1];
+        if (!key->str) continue;
+        if (std::strcmp(key->str, "status") == 0) {
+            out.status = static_cast<DomainStatus>(field_to_ll(value));
+            has_status = true;
+        } else if (std::strcmp(key->str, "action") == 0) {
+            out.action = static_cast<DomainAction>(field_to_ll(value));
+            has_action = true;
+        } else if (std::strcmp(key->str, "query_count") == 0) {
+            out.query_count = static_cast<uint32_t>(field_to_ll(value));
+        } else if (std::strcmp(key->str, "last_updated") == 0) {
+            out.last_updated = static_cast<time_t>(field_to_ll(value));
+        } else if (std::strcmp(key->str, "last_accessed") == 0) {
+            out.last_accessed = static_cast<time_t>(field_to_ll(value));
+        } else if (std::strcmp(key->str, "ttl") == 0) {
+            out.ttl = static_cast<int>(field_to_ll(value));
         }
+    }
+    return has_status && has_action;
+}
 
-        const struct timeval timeout = { REDIS_TIMEOUT_SEC, REDIS_TIMEOUT_USEC };
-        conn = redisConnectWithTimeout(REDIS_HOST, REDIS_PORT, timeout);
+// upsert 脚本：在服务端原子完成 查找 → 过期判断 → 容量淘汰 → 写入 → 加入待上报集合
+// KEYS: [1] dns:entries:<domain>  [2] dns:lru  [3] 待上报集合  [4] 过期索引
+// ARGV: [1] keep_existing  [2] domain  [3] status  [4] action  [5] hits  [6] now
+//       [7] max_size  [8] remove_count  [9..12] TTL（fake, pend, full_permit, full_drop）
+//       [13] 是否以紧凑编码写入
+// 返回：{ inserted, status, action, query_count, now, ttl, {被删除的域名...} }
+const std::string& upsert_script_source() {
+    static const std::string source = std::string(ENTRY_LUA) +
+        "local keep = ARGV[1] == '1'\n"
+        "local domain = ARGV[2]\n"
+        "local status = tonumber(ARGV[3])\n"
+        "local action = tonumber(ARGV[4])\n"
+        "local hits = tonumber(ARGV[5])\n"
+        "local now = tonumber(ARGV[6])\n"
+        "local packed = ARGV[13] == '1'\n"
+        "local deleted = {}\n"
+        "local cur, t = load_entry(KEYS[1])\n"
+        "if cur and cur[4] and cur[6] and cur[4] + cur[6] < now then\n"
+        "  redis.call('DEL', KEYS[1])\n"
+        "  redis.call('ZREM', KEYS[2], domain)\n"
+        "  redis.call('ZREM', KEYS[4], domain)\n"
+        "  deleted[#deleted + 1] = domain\n"
+        "  cur = nil\n"
+        "  t = 'none'\n"
+        "end\n"
+        "local count = hits\n"
+        "if cur then\n"
+        "  count = cur[3]\n"
+        "  if keep then\n"
+        "    status = cur[1]\n"
+        "    action = cur[2]\n"
+        "  end\n"
+        "  if cur[1] == status then count = count + hits end\n"
+        "else\n"
+        "  if redis.call('ZCARD', KEYS[2]) >= tonumber(ARGV[7]) then\n"
+        "    local victims = redis.call('ZRANGE', KEYS[2], 0, tonumber(ARGV[8]) - 1)\n"
+        "    for _, key in ipairs(victims) do\n"
+        "      redis.call('DEL', 'dns:entries:'..key)\n"
+        "      redis.call('ZREM', KEYS[2], key)\n"
+        "      redis.call('ZREM', KEYS[4], key)\n"
+        "      deleted[#deleted + 1] = key\n"
+        "    end\n"
+        "  end\n"
+        "  redis.call('SADD', KEYS[3], domain)\n"
+        "end\n"
+        "local ttl\n"
+        "if status == 0 then ttl = tonumber(ARGV[9])\n"
+        "elseif status == 1 then ttl = tonumber(ARGV[10])\n"
+        "elseif action == 1 then ttl = tonumber(ARGV[11])\n"
+        "else ttl = tonumber(ARGV[12]) end\n"
+        "store_entry(KEYS[1], domain, packed, t, {status, action, count, now, now, ttl})\n"
+        "redis.call('ZADD', KEYS[2], now, domain)\n"
+        "redis.call('ZADD', KEYS[4], now + ttl, domain)\n"
+        "return { cur and 0 or 1, status, action, count, now, ttl, deleted }";
+    return source;
+}
 
-        if (!conn) {
-            throw std::runtime_error("[getConnection] Redis connection allocation failed");
-        }
+// 判定脚本：逐条 查找 → 过期判断 →（PEND 仅作用于 FAKE 条目）→ 容量淘汰 → 写入
+// KEYS: [1] dns:lru  [2] 过期索引  [3] 待上报集合（FULL 判定的域名从中移除）
+// ARGV: [1] now  [2] max_size  [3] remove_count  [4..7] TTL（fake, pend, full_permit, full_drop）
+//       [8] 是否以紧凑编码写入  [9..] 每条判定四个参数：domain, status, action, hits
+// 返回：{ {被删除的域名...}, { {domain, status, action, query_count, ttl}... } }
+const std::string& verdict_script_source() {
+    static const std::string source = std::string(ENTRY_LUA) +
+        "local now = tonumber(ARGV[1])\n"
+        "local packed = ARGV[8] == '1'\n"
+        "local deleted, applied = {}, {}\n"
+        "for i = 9, #ARGV, 4 do\n"
+        "  local domain = ARGV[i]\n"
+        "  local status = tonumber(ARGV[i + 1])\n"
+        "  local action = tonumber(ARGV[i + 2])\n"
+        "  local hits = tonumber(ARGV[i + 3])\n"
+        "  local key = 'dns:entries:'..domain\n"
+        "  local cur, t = load_entry(key)\n"
+        "  if cur and cur[4] and cur[6] and cur[4] + cur[6] < now then\n"
+        "    redis.call('DEL', key)\n"
+        "    redis.call('ZREM', KEYS[1], domain)\n"
+        "    redis.call('ZREM', KEYS[2], domain)\n"
+        "    deleted[#deleted + 1] = domain\n"
+        "    cur = nil\n"
+        "    t = 'none'\n"
+        "  end\n"
+        "  local apply = true\n"
+        "  if status == 1 then\n"
+        "    apply = cur ~= nil and cur[1] == 0\n"
+        "    if apply then action = cur[2] end\n"
+        "  end\n"
+        "  if apply then\n"
+        "    local count = hits\n"
+        "    if cur then\n"
+        "      count = cur[3] + hits\n"
+        "    elseif redis.call('ZCARD', KEYS[1]) >= tonumber(ARGV[2]) then\n"
+        "      local victims = redis.call('ZRANGE', KEYS[1], 0, tonumber(ARGV[3]) - 1)\n"
+        "      for _, victim in ipairs(victims) do\n"
+        "        redis.call('DEL', 'dns:entries:'..victim)\n"
+        "        redis.call('ZREM', KEYS[1], victim)\n"
+        "        redis.call('ZREM', KEYS[2], victim)\n"
+        "        deleted[#deleted + 1] = victim\n"
+        "      end\n"
+        "    end\n"
+        "    local ttl\n"
+        "    if status == 0 then ttl = tonumber(ARGV[4])\n"
+        "    elseif status == 1 then ttl = tonumber(ARGV[5])\n"
+        "    elseif action == 1 then ttl = tonumber(ARGV[6])\n"
+        "    else ttl = tonumber(ARGV[7]) end\n"
+        "    store_entry(key, domain, packed, t, {status, action, count, now, now, ttl})\n"
+        "    redis.call('ZADD', KEYS[1], now, domain)\n"
+        "    redis.call('ZADD', KEYS[2], now + ttl, domain)\n"
+        "    if status == 2 then redis.call('SREM', KEYS[3], domain) end\n"
+        "    applied[#applied + 1] = {domain, status, action, count, ttl}\n"
+        "  end\n"
+        "end\n"
+        "return {deleted, applied}";
+    return source;
+}
 
-        if (conn->err) {
-            std::string err_msg = "[getConnection] Redis connection failed: ";
-            err_msg += conn->errstr ? conn->errstr : "Unknown error";
-            redisFree(conn);
-            conn = nullptr;
-            throw std::runtime_error(err_msg);
-        }
+// 访问次数写回脚本
+// KEYS: [1] 过期索引
+// ARGV: [1] 是否以紧凑编码写入  [2..] 每个域名三个参数：domain, hits, last_accessed
+// 条目仍存在且未过期时累加访问次数、刷新访问/更新时间并更新 LRU 与过期索引；
+// 已被删除或过期的条目丢弃增量（下次查询时重新插入）
+// 返回：写回的域名数
+const std::string& flush_script_source() {
+    static const std::string source = std::string(ENTRY_LUA) +
+        "local packed = ARGV[1] == '1'\n"
+        "local n = 0\n"
+        "for i = 2, #ARGV, 3 do\n"
+        "  local domain = ARGV[i]\n"
+        "  local ts = tonumber(ARGV[i + 2])\n"
+        "  local key = 'dns:entries:'..domain\n"
+        "  local e, t = load_entry(key)\n"
+        "  if e and not (e[4] and e[6] and e[4] + e[6] < ts) then\n"
+        "    e[3] = e[3] + tonumber(ARGV[i + 1])\n"
+        "    e[4] = math.max(e[4] or 0, ts)\n"
+        "    e[5] = math.max(e[5] or 0, ts)\n"
+        "    store_entry(key, domain, packed, t, e)\n"
+        "    redis.call('ZADD', 'dns:lru', e[5], domain)\n"
+        "    if e[6] then redis.call('ZADD', KEYS[1], e[4] + e[6], domain) end\n"
+        "    n = n + 1\n"
+        "  end\n"
+        "end\n"
+        "return n";
+    return source;
+}
 
-        // Redis AUTH
-        std::unique_ptr<redisReply, decltype(&freeReplyObject)> reply(
-            (redisReply*)redisCommand(conn, "AUTH %s", REDIS_PASSWORD),
-            freeReplyObject
-        );
+} // namespace
 
-        if (!reply || reply->type == REDIS_REPLY_ERROR) {
-            std::string err_msg = "[getConnection] Authentication failed: ";
-            err_msg += (reply && reply->str) ? reply->str : "No error message";
-            redisFree(conn);
-            conn = nullptr;
-            throw std::runtime_error(err_msg);
-        }
+RedisDNSCache::RedisDNSCache(size_t max_size, size_t l1_capacity)
+    : max_size(max_size), l1(l1_capacity),
+      upsert_script(upsert_script_source()), verdict_script(verdict_script_source()),
+      flush_script(flush_script_source()) {
+}
 
-        std::cout << "[Redis] Connection authenticated successfully (thread-local)" << std::endl;
+RedisDNSCache::~RedisDNSCache() {
+    // 正常退出时写回尚未刷新的访问次数
+    try {
+        flushQueryCounts();
+    } catch (const std::exception& e) {
+        std::cerr << "[RedisDNS] final query_count flush failed: " << e.what() << std::endl;
     }
-
-    return conn;
 }
 
 void RedisDNSCache::executeCommand(const char* format, ...) {
     va_list ap;
     va_start(ap, format);
 
-    redisContext* conn = getConnection();
     std::unique_ptr<redisReply, decltype(&freeReplyObject)> reply(
-        (redisReply*)redisvCommand(conn, format, ap), freeReplyObject
+        redis.vcommand(format, ap), freeReplyObject
     );
     va_end(ap);
 
@@ -85,9 +300,8 @@ std::string RedisDNSCache::getStringResult(const char* format, ...) {
     va_list ap;
     va_start(ap, format);
 
-    redisContext* conn = getConnection();
     std::unique_ptr<redisReply, decltype(&freeReplyObject)> reply(
-        (redisReply*)redisvCommand(conn, format, ap), freeReplyObject
+        redis.vcommand(format, ap), freeReplyObject
     );
     va_end(ap);
 
@@ -104,77 +318,164 @@ std::string RedisDNSCache::getStringResult(const char* format, ...) {
 }
 
 
-int RedisDNSCache::getTTL(DomainStatus status, DomainAction action) {
-    switch(status) {
-        case DomainStatus::FAKE: return ttl_config.fake;
-        case DomainStatus::PEND: return ttl_config.pend;
-        case DomainStatus::FULL: 
-            return (action == DomainAction::PERMIT) ? ttl_config.full_permit : ttl_config.full_drop;
+size_t RedisDNSCache::sweepExpired(size_t max_batch) {
+    long long now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // 只取出过期索引中已到期的域名（有界批量），代价与缓存总大小无关
+    const char* lua_script =
+        "local due = redis.call('ZRANGEBYSCORE', KEYS[1], '-inf', '(' .. ARGV[1], 'LIMIT', 0, ARGV[2])\n"
+        "for i, key in ipairs(due) do\n"
+        "    redis.call('DEL', 'dns:entries:'..key)\n"
+        "    redis.call('ZREM', 'dns:lru', key)\n"
+        "    redis.call('ZREM', KEYS[1], key)\n"
+        "end\n"
+        "return due";
+
+    std::unique_ptr<redisReply, decltype(&freeReplyObject)> reply(
+        redis.command("EVAL %s 1 %s %lld %zu",
+                                  lua_script, REDIS_EXPIRY_INDEX, now, max_batch),
+        freeReplyObject
+    );
+    if (!reply || reply->type != REDIS_REPLY_ARRAY) {
+        std::string err = (reply && reply->str) ? reply->str : "unexpected reply";
+        throw std::runtime_error("sweepExpired error: " + err);
     }
-    return ttl_config.full_permit;
+
+    evictFromL1(reply.get());
+    return reply->elements;
 }
 
-void RedisDNSCache::makeRoom() {
-    long long current_size = 0;
-    redisReply* reply = (redisReply*)redisCommand(getConnection(), "ZCARD dns:lru");
-    if (reply && reply->type == REDIS_REPLY_INTEGER) {
-        current_size = reply->integer;
+bool RedisDNSCache::backfillExpiryIndex(std::string& cursor, size_t batch) {
+    std::unique_ptr<redisReply, decltype(&freeReplyObject)> scan(
+        redis.command("ZSCAN dns:lru %s COUNT %zu", cursor.c_str(), batch),
+        freeReplyObject
+    );
+    if (!scan || scan->type != REDIS_REPLY_ARRAY || scan->elements != 2) {
+        std::string err = (scan && scan->str) ? scan->str : "unexpected reply";
+        throw std::runtime_error("backfillExpiryIndex error: " + err);
+    }
+    cursor.assign(scan->element[0]->str, scan->element[0]->len);
+
+    // ZSCAN 返回 [member, score, member, score, ...]，只取域名
+    const redisReply* items = scan->element[1];
+    std::vector<const char*> argv = {"EVAL", nullptr, "1", REDIS_EXPIRY_INDEX};
+    std::vector<size_t> argvlen = {4, 0, 1, std::strlen(REDIS_EXPIRY_INDEX)};
+    for (size_t i = 0; i + 1 < items->elements; i += 2) {
+        argv.push_back(items->element[i]->str);
+        argvlen.push_back(items->element[i]->len);
     }
-    freeReplyObject(reply);
-
-    if (current_size >= max_size) {
-        int remove_count = std::max(2, static_cast<int>(max_size * 0.1));
 
-        const char* lua_script = 
-            "local keys = redis.call('ZRANGE', 'dns:lru', 0, ARGV[1])\n"
-            "for i, key in ipairs(keys) do\n"
-            "  redis.call('DEL', 'dns:entries:'..key)\n"
-            "  redis.call('ZREM', 'dns:lru', key)\n"
+    if (argv.size() > 4) {
+        // 已有索引的条目保持不变（NX），哈希已不存在的域名从 dns:lru 中移除
+        static const std::string lua_script = std::string(ENTRY_LUA) +
+            "for i, key in ipairs(ARGV) do\n"
+            "    local e = load_entry('dns:entries:'..key)\n"
+            "    if e and e[4] and e[6] then\n"
+            "        redis.call('ZADD', KEYS[1], 'NX', e[4] + e[6], key)\n"
+            "    else\n"
+            "        redis.call('ZREM', 'dns:lru', key)\n"
+            "    end\n"
             "end\n"
-            "return #keys";
+            "return #ARGV";
+        argv[1] = lua_script.c_str();
+        argvlen[1] = lua_script.size();
+
+        std::unique_ptr<redisReply, decltype(&freeReplyObject)> reply(
+            redis.commandArgv(static_cast<int>(argv.size()), argv.data(), argvlen.data()),
+            freeReplyObject
+        );
+        if (!reply || reply->type == REDIS_REPLY_ERROR) {
+            std::string err = (reply && reply->str) ? reply->str : "no reply";
+            throw std::runtime_error("backfillExpiryIndex error: " + err);
+        }
+    }
+
+    return cursor == "0";
+}
 
-        redisReply* lua_reply = (redisReply*)redisCommand(getConnection(),
-            "EVAL %s 0 %d", lua_script, remove_count - 1);
-        freeReplyObject(lua_reply);
+void RedisDNSCache::evictFromL1(redisReply* deleted_keys) {
+    if (!deleted_keys || deleted_keys->type != REDIS_REPLY_ARRAY) return;
+    for (size_t i = 0; i < deleted_keys->elements; ++i) {
+        const redisReply* key = deleted_keys->element[i];
+        if (key->type == REDIS_REPLY_STRING) {
+            l1.erase(std::string_view(key->str, key->len));
+        }
     }
 }
 
+void RedisDNSCache::setEntryEncoding(EntryEncoding enc) {
+    encoding.store(enc);
+}
 
-void RedisDNSCache::cleanupExpired() {
-    
-    long long now = std::chrono::duration_cast<std::chrono::seconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count();
-    
-    const char* lua_script = 
-        "local keys = redis.call('ZRANGE', 'dns:lru', 0, -1)\n"
-        "for i, key in ipairs(keys) do\n"
-        "    local ttl = redis.call('HGET', 'dns:entries:'..key, 'ttl')\n"
-        "    local updated = redis.call('HGET', 'dns:entries:'..key, 'last_updated')\n"
-        "    if ttl and updated and tonumber(updated) + tonumber(ttl) < tonumber(ARGV[1]) then\n"
-        "        redis.call('DEL', 'dns:entries:'..key)\n"
-        "        redis.call('ZREM', 'dns:lru', key)\n"
-        "    end\n"
+EntryEncoding RedisDNSCache::entryEncoding() const {
+    return encoding.load();
+}
+
+std::future<RedisReplyPtr> RedisDNSCache::requestEntry(const std::string& domain, EntryEncoding enc) {
+    if (enc == EntryEncoding::PACKED) {
+        return redis.commandAsync("GET dns:entries:%b", domain.data(), domain.size());
+    }
+    return redis.commandAsync("HGETALL dns:entries:%b", domain.data(), domain.size());
+}
+
+bool RedisDNSCache::loadEntry(const std::string& domain, std::future<RedisReplyPtr>& pending,
+                              DomainL1Cache::Value& out) {
+    RedisReplyPtr reply = pending.get();
+    // 迁移未完成时条目可能仍是另一种编码（WRONGTYPE），改用对应命令重新读取
+    if (reply && reply->type == REDIS_REPLY_ERROR && reply->str &&
+        std::strncmp(reply->str, "WRONGTYPE", 9) == 0) {
+        EntryEncoding other = encoding.load() == EntryEncoding::PACKED
+            ? EntryEncoding::HASH : EntryEncoding::PACKED;
+        reply = requestEntry(domain, other).get();
+    }
+    return decode_entry(reply.get(), out);
+}
+
+size_t RedisDNSCache::migrateEntries(EntryEncoding target, size_t batch) {
+    // ARGV: [1] 目标是否为紧凑编码  [2..] 域名；已是目标编码的条目保持不变
+    static const std::string lua_script = std::string(ENTRY_LUA) +
+        "local packed = ARGV[1] == '1'\n"
+        "local n = 0\n"
+        "for i = 2, #ARGV do\n"
+        "  local key = 'dns:entries:'..ARGV[i]\n"
+        "  local e, t = load_entry(key)\n"
+        "  if e and ((packed and t == 'hash') or (not packed and t == 'string')) then\n"
+        "    store_entry(key, ARGV[i], packed, t, e)\n"
+        "    n = n + 1\n"
+        "  end\n"
         "end\n"
-        "return #keys";
-    
-    // 释放锁后再执行Lua脚本
-    redisReply* reply = (redisReply*)redisCommand(getConnection(), 
-        "EVAL %s 0 %lld", lua_script, now);
-    freeReplyObject(reply);
+        "return n";
+
+    const char* flag = target == EntryEncoding::PACKED ? "1" : "0";
+    size_t migrated = 0;
+    scanDomains(batch, [&](const std::vector<std::string>& domains) {
+        std::vector<const char*> argv = {"EVAL", lua_script.c_str(), "0", flag};
+        std::vector<size_t> argvlen = {4, lua_script.size(), 1, 1};
+        for (const auto& domain : domains) {
+            argv.push_back(domain.c_str());
+            argvlen.push_back(domain.size());
+        }
+
+        RedisReplyPtr reply(redis.commandArgv(static_cast<int>(argv.size()), argv.data(), argvlen.data()));
+        if (!reply || reply->type != REDIS_REPLY_INTEGER) {
+            std::string err = (reply && reply->str) ? reply->str : "unexpected reply";
+            throw std::runtime_error("migrateEntries error: " + err);
+        }
+        migrated += static_cast<size_t>(reply->integer);
+        return true;
+    });
+    return migrated;
+}
+
+L1CacheStats RedisDNSCache::l1Stats() const {
+    return l1.stats();
 }
 
 void RedisDNSCache::printAllData() {
     try {
         std::cout << "\n=== Current Redis DNS Cache Contents ===\n";
 
-        // 获取所有域名键（按照 LRU 排序）
-        redisReply* keys_reply = (redisReply*)redisCommand(getConnection(), "ZRANGE dns:lru 0 -1");
-        if (!keys_reply || keys_reply->type != REDIS_REPLY_ARRAY) {
-            std::cerr << "Failed to get keys from dns:lru" << std::endl;
-            if (keys_reply) freeReplyObject(keys_reply);
-            return;
-        }
-
         // 打印主缓存表头
         std::cout << std::left << std::setw(50) << "Domain"
                   << std::setw(10) << "Status"
@@ -186,42 +487,39 @@ void RedisDNSCache::printAllData() {
                   << std::endl;
         std::cout << std::string(130, '-') << std::endl;
 
-        // 遍历所有缓存条目
-        for (size_t i = 0; i < keys_reply->elements; i++) {
-            std::string domain(keys_reply->element[i]->str, keys_reply->element[i]->len);
-
-            // 获取域名详细字段
-            redisReply* entry_reply = (redisReply*)redisCommand(
-                getConnection(), "HGETALL dns:entries:%s", domain.c_str());
+        // 按游标分批遍历所有缓存条目，每批的读取命令流水线发送
+        size_t total = 0;
+        std::vector<std::future<RedisReplyPtr>> pending;
+        scanDomains(REDIS_SCAN_BATCH, [&](const std::vector<std::string>& domains) {
+            EntryEncoding enc = encoding.load();
+            pending.clear();
+            for (const auto& domain : domains) {
+                pending.push_back(requestEntry(domain, enc));
+            }
 
-            if (entry_reply && entry_reply->type == REDIS_REPLY_ARRAY && entry_reply->elements > 0) {
-                std::map<std::string, std::string> fields;
-                for (size_t j = 0; j < entry_reply->elements; j += 2) {
-                    std::string key(entry_reply->element[j]->str, entry_reply->element[j]->len);
-                    std::string value(entry_reply->element[j + 1]->str, entry_reply->element[j + 1]->len);
-                    fields[key] = value;
-                }
+            for (size_t i = 0; i < domains.size(); ++i) {
+                DomainL1Cache::Value value;
+                if (!loadEntry(domains[i], pending[i], value)) continue;
 
                 // 打印每个域名条目
-                std::cout << std::left << std::setw(50) << domain
-                          << std::setw(10) << statusToString(static_cast<DomainStatus>(std::stoi(fields["status"])))
-                          << std::setw(10) << actionToString(static_cast<DomainAction>(std::stoi(fields["action"])))
-                          << std::setw(10) << fields["query_count"]
-                          << std::setw(20) << fields["last_updated"]
-                          << std::setw(20) << fields["last_accessed"]
-                          << std::setw(10) << fields["ttl"]
+                std::cout << std::left << std::setw(50) << domains[i]
+                          << std::setw(10) << statusToString(value.status)
+                          << std::setw(10) << actionToString(value.action)
+                          << std::setw(10) << value.query_count
+                          << std::setw(20) << value.last_updated
+                          << std::setw(20) << value.last_accessed
+                          << std::setw(10) << value.ttl
                           << std::endl;
+                ++total;
             }
+            return true;
+        });
 
-            if (entry_reply) freeReplyObject(entry_reply);
-        }
-
-        std::cout << "=== Total entries: " << keys_reply->elements << " ===\n\n";
-        freeReplyObject(keys_reply);
+        std::cout << "=== Total entries: " << total << " ===\n\n";
 
         // 打印待上报集合 dns:pending_set
         std::cout << "\n=== Domains in Pending Report Set (dns:pending_set) ===\n";
-        redisReply* set_reply = (redisReply*)redisCommand(getConnection(), "SMEMBERS %s", REDIS_PENDING_REPORT_SET);
+        redisReply* set_reply = redis.command("SMEMBERS %s", REDIS_PENDING_REPORT_SET);
         if (set_reply && set_reply->type == REDIS_REPLY_ARRAY) {
             if (set_reply->elements == 0) {
                 std::cout << "(empty set)\n";
@@ -245,11 +543,7 @@ void RedisDNSCache::printAllData() {
 
 void RedisDNSCache::addToPendingReportSet(const std::string& domain) {
     std::lock_guard<std::mutex> lock(mtx);
-    redisContext* conn = getConnection();
-    if (!conn) {
-        throw std::runtime_error("Redis connection failed");
-    }
-    redisReply* reply = (redisReply*)redisCommand(conn, "SADD %s %s", REDIS_PENDING_REPORT_SET, domain.c_str());
+    redisReply* reply = redis.command("SADD %s %s", REDIS_PENDING_REPORT_SET, domain.c_str());
     if (!reply) {
         throw std::runtime_error("Failed to execute SADD command");
     }
@@ -259,12 +553,7 @@ void RedisDNSCache::addToPendingReportSet(const std::string& domain) {
 std::vector<std::string> RedisDNSCache::getPendingReportDomains() {
     std::lock_guard<std::mutex> lock(mtx);
     std::vector<std::string> domains;
-    redisContext* conn = getConnection();
-    if (!conn) {
-        throw std::runtime_error("Redis connection failed");
-    }
-
-    redisReply* reply = (redisReply*)redisCommand(conn, "SMEMBERS %s", REDIS_PENDING_REPORT_SET);
+    redisReply* reply = redis.command("SMEMBERS %s", REDIS_PENDING_REPORT_SET);
     if (!reply) {
         throw std::runtime_error("Failed to execute SMEMBERS command");
     }
@@ -280,16 +569,11 @@ std::vector<std::string> RedisDNSCache::getPendingReportDomains() {
 
 int RedisDNSCache::getPendingReportCount() {
     std::lock_guard<std::mutex> lock(mtx);
-    redisContext* conn = getConnection();
-    if (!conn) {
-        throw std::runtime_error("Redis connection failed");
+    redisReply* reply = redis.command("SCARD %s", REDIS_PENDING_REPORT_SET);
+    if (!reply) {
+        throw std::runtime_error("Failed to execute SCARD command");
     }
 
-    redisReply* reply = (redisReply*)redisCommand(conn, "SCARD %s", REDIS_PENDING_REPORT_SET);
-    // if (!reply) {
-    //     throw std::runtime_error("Failed to execute SCARD command");
-    // }
-
     int count = 0;
     if (reply->type == REDIS_REPLY_INTEGER) {
         count = static_cast<int>(reply->integer);
@@ -300,175 +584,473 @@ int RedisDNSCache::getPendingReportCount() {
 
 void RedisDNSCache::clearPendingReportDomains() {
     std::lock_guard<std::mutex> lock(mtx);
-    redisContext* conn = getConnection();
-    if (!conn) {
-        throw std::runtime_error("Redis connection failed");
-    }
-    redisReply* reply = (redisReply*)redisCommand(conn, "DEL %s", REDIS_PENDING_REPORT_SET);
+    redisReply* reply = redis.command("DEL %s", REDIS_PENDING_REPORT_SET);
     if (!reply) {
         throw std::runtime_error("Failed to execute DEL command");
     }
     freeReplyObject(reply);
 }
 
-std::unordered_map<std::string, RedisDNSCache::DomainMeta> RedisDNSCache::getAllDomainData() {
-    std::unordered_map<std::string, RedisDNSCache::DomainMeta> result;
+void RedisDNSCache::removePendingReportDomains(const std::vector<std::string>& domains) {
+    if (domains.empty()) return;
 
-    redisReply* reply = (redisReply*)redisCommand(getConnection(), "ZRANGE dns:lru 0 -1");
-    if (!reply || reply->type != REDIS_REPLY_ARRAY) {
-        if (reply) freeReplyObject(reply);
-        // throw std::runtime_error("Failed to fetch domain keys from dns:lru");
-        // return std::nullopt;
+    std::lock_guard<std::mutex> lock(mtx);
+    // SREM key member [member ...]，一次往返移除整批域名
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+    argv.reserve(domains.size() + 2);
+    argvlen.reserve(domains.size() + 2);
+    argv.push_back("SREM");
+    argvlen.push_back(4);
+    argv.push_back(REDIS_PENDING_REPORT_SET);
+    argvlen.push_back(std::strlen(REDIS_PENDING_REPORT_SET));
+    for (const auto& domain : domains) {
+        argv.push_back(domain.c_str());
+        argvlen.push_back(domain.size());
     }
 
-    for (size_t i = 0; i < reply->elements; ++i) {
-        std::string domain = reply->element[i]->str;
-        std::string hash_key = "dns:entries:" + domain;
+    redisReply* reply = redis.commandArgv(static_cast<int>(argv.size()),
+                                          argv.data(), argvlen.data());
+    if (!reply) {
+        throw std::runtime_error("Failed to execute SREM command");
+    }
+    freeReplyObject(reply);
+}
 
-        redisReply* data = (redisReply*)redisCommand(getConnection(),
-            "HMGET %s status action query_count", hash_key.c_str());
+bool RedisDNSCache::scanDomains(size_t batch,
+                                const std::function<bool(const std::vector<std::string>&)>& on_batch) {
+    std::string cursor = "0";
+    std::vector<std::string> domains;
+    do {
+        RedisReplyPtr scan(redis.command("ZSCAN dns:lru %s COUNT %zu", cursor.c_str(), batch));
+        if (!scan || scan->type != REDIS_REPLY_ARRAY || scan->elements != 2) {
+            std::string err = (scan && scan->str) ? scan->str : "unexpected reply";
+            throw std::runtime_error("scanDomains error: " + err);
+        }
+        cursor.assign(scan->element[0]->str, scan->element[0]->len);
 
-        if (!data || data->type != REDIS_REPLY_ARRAY || data->elements < 3) {
-            if (data) freeReplyObject(data);
-            continue;
+        // ZSCAN 返回 [member, score, member, score, ...]，只取域名
+        const redisReply* items = scan->element[1];
+        domains.clear();
+        for (size_t i = 0; i + 1 < items->elements; i += 2) {
+            domains.emplace_back(items->element[i]->str, items->element[i]->len);
         }
+        if (!domains.empty() && !on_batch(domains)) return false;
+    } while (cursor != "0");
+    return true;
+}
 
-        DomainMeta meta;
-        if (data->element[0]->str)
-            meta.status = static_cast<DomainStatus>(std::stoi(data->element[0]->str));
-        if (data->element[1]->str)
-            meta.action = static_cast<DomainAction>(std::stoi(data->element[1]->str));
-        if (data->element[2]->str)
-            meta.query_count = std::stoul(data->element[2]->str);
-        else
-            meta.query_count = 0;
+void RedisDNSCache::forEachDomain(
+    const std::function<bool(const std::string&, const DomainMeta&)>& visit) {
+    std::vector<std::future<RedisReplyPtr>> pending;
 
-        result[domain] = meta;
+    scanDomains(REDIS_SCAN_BATCH, [&](const std::vector<std::string>& domains) {
+        // 整批读取命令同时发出（流水线），再按顺序取回复，每批只等待一次往返
+        EntryEncoding enc = encoding.load();
+        pending.clear();
+        for (const auto& domain : domains) {
+            pending.push_back(requestEntry(domain, enc));
+        }
 
-        freeReplyObject(data);
-    }
+        for (size_t i = 0; i < domains.size(); ++i) {
+            // 条目已被删除（过期清理与 LRU 淘汰之间的短暂窗口）时跳过
+            DomainL1Cache::Value value;
+            if (!loadEntry(domains[i], pending[i], value)) continue;
 
-    freeReplyObject(reply);
-    return result;
+            DomainMeta meta{value.status, value.action, value.query_count};
+            if (!visit(domains[i], meta)) return false;  // 未取的回复随 future 析构丢弃
+        }
+        return true;
+    });
 }
 
-void RedisDNSCache::resetQueryCount(const std::string& domain) {
-    std::lock_guard<std::mutex> lock(mtx);
-    std::string hash_key = "dns:entries:" + domain;
+void RedisDNSCache::resetQueryCounts(const std::vector<std::string>& domains) {
+    if (domains.empty()) return;
+
+    // 两种编码分别就地清零（紧凑编码只覆盖 query_count 的 4 个字节），不存在的条目不会被创建
+    static const char* lua_script =
+        "for i, domain in ipairs(ARGV) do\n"
+        "  local key = 'dns:entries:'..domain\n"
+        "  local t = redis.call('TYPE', key).ok\n"
+        "  if t == 'string' then\n"
+        "    redis.call('SETRANGE', key, 1, struct.pack('<I4', 0))\n"
+        "  elseif t == 'hash' then\n"
+        "    redis.call('HSET', key, 'query_count', 0)\n"
+        "  end\n"
+        "end\n"
+        "return #ARGV";
 
-    redisReply* reply = (redisReply*)redisCommand(getConnection(),
-        "HSET %s query_count 0", hash_key.c_str());
+    std::vector<const char*> argv = {"EVAL", lua_script, "0"};
+    std::vector<size_t> argvlen = {4, std::strlen(lua_script), 1};
+    for (const auto& domain : domains) {
+        argv.push_back(domain.c_str());
+        argvlen.push_back(domain.size());
+    }
 
-    if (!reply || (reply->type == REDIS_REPLY_ERROR)) {
-        if (reply) freeReplyObject(reply);
-        std::cerr << "[RedisDNS] Failed to reset query_count for domain: " << domain << "\n";
+    RedisReplyPtr reply(redis.commandArgv(static_cast<int>(argv.size()), argv.data(), argvlen.data()));
+    if (!reply || reply->type == REDIS_REPLY_ERROR) {
+        std::cerr << "[RedisDNS] Failed to reset query_count for " << domains.size() << " domains: "
+                  << ((reply && reply->str) ? reply->str : "no reply") << "\n";
         return;
     }
+    for (const auto& domain : domains) {
+        l1.erase(domain);  // 下次 find 从 Redis 重新加载
+    }
+}
 
-    // std::cout << "[RedisDNS] Reset query_count for domain: " << domain << "\n";
-    freeReplyObject(reply);
+std::shared_ptr<RedisDNSCache::DomainEntry> RedisDNSCache::upsert(
+    const std::string& domain, DomainStatus status, DomainAction action, uint32_t hits, bool* inserted) {
+    return runUpsert(domain, status, action, hits, false, inserted);
 }
 
-bool RedisDNSCache::insert(const std::string& domain, DomainStatus status, DomainAction action) {
-    try {
-        makeRoom();
-        
-        long long now = std::chrono::duration_cast<std::chrono::seconds>(
-            std::chrono::system_clock::now().time_since_epoch()).count();
-        int ttl = getTTL(status, action);
+std::shared_ptr<RedisDNSCache::DomainEntry> RedisDNSCache::recordQuery(
+    const std::string& domain, uint32_t hits, bool* inserted) {
+    // 写回模式：L1 中已有且未过期的域名只在内存中累加，由刷新线程批量写回 Redis
+    if (write_behind_enabled.load(std::memory_order_relaxed)) {
+        time_t now = std::time(nullptr);
+        DomainL1Cache::Value cached;
+        if (l1.get(domain, now, cached)) {
+            // 增量被缓冲区接纳后才累加 L1 中的访问次数：缓冲区已满而丢弃的增量在 L1 与 Redis 中都不计入
+            if (write_behind.add(domain, hits, now)) l1.touch(domain, now, hits, cached);
+            if (write_behind.size() >= WRITE_BEHIND_MAX_PENDING && flushRetryDue()) {
+                // 大小触发：由当前线程立即刷新，其他线程正在刷新或上次刷新失败不久时跳过
+                std::unique_lock<std::mutex> lock(flush_mutex, std::try_to_lock);
+                if (lock.owns_lock()) flushQueryCountsLocked();
+            }
+            if (inserted) *inserted = false;
+            return std::make_shared<DomainEntry>(DomainEntry{
+                domain, cached.status, cached.action, cached.query_count,
+                cached.last_updated, cached.last_accessed});
+        }
+    }
+    return runUpsert(domain, DomainStatus::FAKE, DomainAction::DROP, hits, true, inserted);
+}
 
-        std::cout << "[RedisDNS] Adding domain: " << domain
-                  << " (Status: " << statusToString(status)
-                  << ", Action: " << actionToString(action)
-                  << ", TTL: " << ttl << "s)" << std::endl;
+void RedisDNSCache::setWriteBehind(bool enabled) {
+    write_behind_enabled.store(enabled);
+}
 
-        executeCommand(
-            "HMSET dns:entries:%s domain %s status %d action %d "
-            "last_updated %lld last_accessed %lld query_count %d ttl %d",
-            domain.c_str(), domain.c_str(), static_cast<int>(status),
-            static_cast<int>(action), now, now, 1, ttl);
+size_t RedisDNSCache::pendingQueryCounts() const {
+    return write_behind.size();
+}
 
-        executeCommand("ZADD dns:lru %lld %s", now, domain.c_str());
-        addToPendingReportSet(domain);
+bool RedisDNSCache::flushRetryDue() const {
+    long long failed_at = flush_failed_at.load(std::memory_order_relaxed);
+    if (failed_at == 0) return true;
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return now - std::chrono::steady_clock::duration(failed_at) >= WRITE_BEHIND_RETRY_DELAY;
+}
 
-        return true;
+size_t RedisDNSCache::flushQueryCounts() {
+    std::lock_guard<std::mutex> lock(flush_mutex);
+    return flushQueryCountsLocked();
+}
+
+size_t RedisDNSCache::flushQueryCountsLocked() {
+    std::vector<std::pair<std::string, WriteBehindBuffer::Delta>> deltas;
+    write_behind.drain(deltas);
+    if (deltas.empty()) return 0;
+
+    const char* packed = encoding.load() == EntryEncoding::PACKED ? "1" : "0";
+
+    // 每 WRITE_BEHIND_FLUSH_BATCH 个域名一次 EVALSHA，全部批次先发出（流水线）再统一等待回复
+    struct Batch {
+        size_t begin, end;
+        ScriptArgs args;
+        std::future<RedisReplyPtr> reply;
+    };
+    std::vector<Batch> batches;
+    std::vector<std::string> numbers;  // hits / last_accessed 的字符串形式，需在发送前保持有效
+    numbers.reserve(deltas.size() * 2);
+    for (const auto& item : deltas) {
+        numbers.push_back(std::to_string(item.second.hits));
+        numbers.push_back(std::to_string(static_cast<long long>(item.second.last_accessed)));
+    }
+
+    // 写回失败（Redis 不可用或脚本加载失败）：增量放回缓冲区，下次刷新时重试。
+    // 缓冲区有容量上限，放不下的增量计入丢弃数；失败后大小触发的刷新推迟 WRITE_BEHIND_RETRY_DELAY
+    auto restore = [&](size_t begin, size_t end, const char* error) {
+        std::cerr << "[RedisDNS] query_count flush failed: " << error << "\n";
+        for (size_t i = begin; i < end; ++i) {
+            write_behind.add(deltas[i].first, deltas[i].second.hits, deltas[i].second.last_accessed);
+        }
+        flush_failed_at.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                              std::memory_order_relaxed);
+    };
+
+    bool failed = false;
+    try {
+        for (size_t begin = 0; begin < deltas.size(); begin += WRITE_BEHIND_FLUSH_BATCH) {
+            size_t end = std::min(deltas.size(), begin + WRITE_BEHIND_FLUSH_BATCH);
+            Batch batch{begin, end, ScriptArgs{}, {}};
+            batch.args.add("1", 1);
+            batch.args.add(REDIS_EXPIRY_INDEX, std::strlen(REDIS_EXPIRY_INDEX));
+            batch.args.add(packed, 1);
+            for (size_t i = begin; i < end; ++i) {
+                batch.args.add(deltas[i].first);
+                batch.args.add(numbers[2 * i]);
+                batch.args.add(numbers[2 * i + 1]);
+            }
+            batch.reply = evalScriptAsync(flush_script, batch.args);
+            batches.push_back(std::move(batch));
+        }
     } catch (const std::exception& e) {
-        std::cerr << "Redis insert error: " << e.what() << std::endl;
-        return false;
+        // 已发出的批次照常等待回复，未发出的部分整体放回
+        size_t sent = batches.empty() ? 0 : batches.back().end;
+        restore(sent, deltas.size(), e.what());
+        failed = true;
+    }
+
+    size_t written = 0;
+    for (auto& batch : batches) {
+        RedisReplyPtr reply = awaitScript(flush_script, batch.args, batch.reply);
+        if (reply && reply->type == REDIS_REPLY_INTEGER) {
+            written += static_cast<size_t>(reply->integer);
+            continue;
+        }
+        restore(batch.begin, batch.end, (reply && reply->str) ? reply->str : "no reply");
+        failed = true;
+    }
+    if (!failed) {
+        flush_failed_at.store(0, std::memory_order_relaxed);
+    } else if (write_behind.dropped() > 0) {
+        std::cerr << "[RedisDNS] write-behind buffer full, " << write_behind.dropped()
+                  << " query_count deltas dropped so far\n";
+    }
+    return written;
+}
+
+const std::string& RedisDNSCache::scriptSha(LuaScript& script) {
+    std::call_once(script.loaded, [this, &script] {
+        std::unique_ptr<redisReply, decltype(&freeReplyObject)> reply(
+            redis.command("SCRIPT LOAD %s", script.source.c_str()),
+            freeReplyObject
+        );
+        if (!reply || reply->type != REDIS_REPLY_STRING) {
+            std::string err = (reply && reply->str) ? reply->str : "unknown error";
+            throw std::runtime_error("SCRIPT LOAD failed: " + err);  // 未加载成功，下次调用重试
+        }
+        script.sha.assign(reply->str, reply->len);
+    });
+    return script.sha;
+}
+
+std::future<RedisReplyPtr> RedisDNSCache::sendScript(const char* command, const std::string& body,
+                                                     const ScriptArgs& args) {
+    std::vector<const char*> argv = {command, body.c_str()};
+    std::vector<size_t> argvlen = {std::strlen(command), body.size()};
+    argv.insert(argv.end(), args.argv.begin(), args.argv.end());
+    argvlen.insert(argvlen.end(), args.argvlen.begin(), args.argvlen.end());
+    return redis.commandArgvAsync(static_cast<int>(argv.size()), argv.data(), argvlen.data());
+}
+
+std::future<RedisReplyPtr> RedisDNSCache::evalScriptAsync(LuaScript& script, const ScriptArgs& args) {
+    return sendScript("EVALSHA", scriptSha(script), args);
+}
+
+RedisReplyPtr RedisDNSCache::awaitScript(LuaScript& script, const ScriptArgs& args,
+                                         std::future<RedisReplyPtr>& pending) {
+    RedisReplyPtr reply = pending.get();
+    // 脚本缓存被清空（Redis 重启或 SCRIPT FLUSH）时回退为 EVAL，同时重新缓存脚本
+    if (reply && reply->type == REDIS_REPLY_ERROR && reply->str &&
+        std::strncmp(reply->str, "NOSCRIPT", 8) == 0) {
+        reply = sendScript("EVAL", script.source, args).get();
     }
+    return reply;
 }
 
-bool RedisDNSCache::update(const std::shared_ptr<DomainEntry>& existing_entry, const std::string& domain, DomainStatus status, DomainAction action) {
+std::shared_ptr<RedisDNSCache::DomainEntry> RedisDNSCache::runUpsert(
+    const std::string& domain, DomainStatus status, DomainAction action, uint32_t hits,
+    bool keep_existing, bool* inserted) {
     try {
         long long now = std::chrono::duration_cast<std::chrono::seconds>(
             std::chrono::system_clock::now().time_since_epoch()).count();
-        int ttl = getTTL(status, action);
 
-        std::cout << "[RedisDNS] Updating domain: " << domain
-                  << " (Status: " << statusToString(status)
-                  << ", Action: " << actionToString(action)
-                  << ", TTL: " << ttl << "s)" << std::endl;
+        std::string entry_key = "dns:entries:" + domain;
+        std::string args[] = {
+            keep_existing ? "1" : "0",
+            domain,
+            std::to_string(static_cast<int>(status)),
+            std::to_string(static_cast<int>(action)),
+            std::to_string(hits),
+            std::to_string(now),
+            std::to_string(max_size),
+            std::to_string(evictionBatch(max_size)),
+            std::to_string(ttl_config.fake),
+            std::to_string(ttl_config.pend),
+            std::to_string(ttl_config.full_permit),
+            std::to_string(ttl_config.full_drop),
+            encoding.load() == EntryEncoding::PACKED ? "1" : "0",
+        };
+
+        // EVALSHA <sha> 4 key lru pending expiry argv...
+        ScriptArgs script_args;
+        script_args.add("4", 1);
+        script_args.add(entry_key);
+        script_args.add("dns:lru", 7);
+        script_args.add(REDIS_PENDING_REPORT_SET, std::strlen(REDIS_PENDING_REPORT_SET));
+        script_args.add(REDIS_EXPIRY_INDEX, std::strlen(REDIS_EXPIRY_INDEX));
+        for (const auto& arg : args) {
+            script_args.add(arg);
+        }
 
-        uint32_t new_query_count = (existing_entry->status == status)
-            ? existing_entry->query_count + 1
-            : existing_entry->query_count;
+        auto pending = evalScriptAsync(upsert_script, script_args);
+        RedisReplyPtr reply = awaitScript(upsert_script, script_args, pending);
 
-        executeCommand(
-            "HMSET dns:entries:%s domain %s status %d action %d "
-            "last_updated %lld last_accessed %lld query_count %d ttl %d",
-            domain.c_str(), domain.c_str(), static_cast<int>(status),
-            static_cast<int>(action), now, now, new_query_count, ttl);
+        if (!reply || reply->type != REDIS_REPLY_ARRAY || reply->elements < 7) {
+            std::string err = (reply && reply->str) ? reply->str : "unexpected reply";
+            throw std::runtime_error("upsert script error: " + err);
+        }
 
-        executeCommand("ZADD dns:lru %lld %s", now, domain.c_str());
+        auto entry = std::make_shared<DomainEntry>();
+        bool is_new = reply->element[0]->integer == 1;
+        entry->domain = domain;
+        entry->status = static_cast<DomainStatus>(reply->element[1]->integer);
+        entry->action = static_cast<DomainAction>(reply->element[2]->integer);
+        entry->query_count = static_cast<uint32_t>(reply->element[3]->integer);
+        entry->last_updated = static_cast<time_t>(reply->element[4]->integer);
+        entry->last_accessed = entry->last_updated;
+        int ttl = static_cast<int>(reply->element[5]->integer);
+
+        std::cout << "[RedisDNS] " << (is_new ? "Adding" : "Updating") << " domain: " << domain
+                  << " (Status: " << statusToString(entry->status)
+                  << ", Action: " << actionToString(entry->action)
+                  << ", TTL: " << ttl << "s)" << std::endl;
 
-        return true;
+        // 先移除脚本删除的域名（可能包含本域名的过期旧条目），再写入新值
+        evictFromL1(reply->element[6]);
+        l1.put(domain, DomainL1Cache::Value{entry->status, entry->action, entry->query_count,
+                                            entry->last_updated, entry->last_accessed, ttl});
+
+        if (inserted) *inserted = is_new;
+        return entry;
     } catch (const std::exception& e) {
-        std::cerr << "Redis update error: " << e.what() << std::endl;
-        return false;
+        std::cerr << "Redis upsert error: " << e.what() << std::endl;
+        return nullptr;
     }
 }
 
-bool RedisDNSCache::insertOrUpdate(const std::string& domain, DomainStatus status, DomainAction action) {
-    cleanupExpired();
-    std::shared_ptr<DomainEntry> existing_entry = find(domain);
-    if (existing_entry == nullptr) {
-        return insert(domain, status, action);
-    } else {
-        return update(existing_entry, domain, status, action);
+size_t RedisDNSCache::applyVerdicts(const std::vector<DomainVerdict>& verdicts) {
+    if (verdicts.empty()) return 0;
+
+    static const char* const kDigits[] = {"0", "1", "2"};
+
+    long long now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string head[] = {
+        std::to_string(now),
+        std::to_string(max_size),
+        std::to_string(evictionBatch(max_size)),
+        std::to_string(ttl_config.fake),
+        std::to_string(ttl_config.pend),
+        std::to_string(ttl_config.full_permit),
+        std::to_string(ttl_config.full_drop),
+        encoding.load() == EntryEncoding::PACKED ? "1" : "0",
+    };
+
+    // 写回模式：L1 中已是同一 FULL 判定的条目只需累加访问次数，不访问 Redis
+    // （反复查询的白名单域名走这条路径，与 recordQuery 的写回路径相同）
+    size_t applied = 0;
+    std::vector<const DomainVerdict*> remote;
+    remote.reserve(verdicts.size());
+    bool write_back = write_behind_enabled.load(std::memory_order_relaxed);
+    for (const auto& verdict : verdicts) {
+        DomainL1Cache::Value cached;
+        if (write_back && verdict.hits > 0 && verdict.status == DomainStatus::FULL &&
+            l1.get(verdict.domain, static_cast<time_t>(now), cached) &&
+            cached.status == DomainStatus::FULL && cached.action == verdict.action) {
+            if (write_behind.add(verdict.domain, verdict.hits, static_cast<time_t>(now))) {
+                l1.touch(verdict.domain, static_cast<time_t>(now), verdict.hits, cached);
+            }
+            ++applied;
+            continue;
+        }
+        remote.push_back(&verdict);
+    }
+
+    std::vector<std::string> hits;  // 访问次数的字符串形式，需在回复返回前保持有效
+    hits.reserve(remote.size());
+    for (const DomainVerdict* verdict : remote) {
+        hits.push_back(std::to_string(verdict->hits));
     }
-}
 
-std::shared_ptr<RedisDNSCache::DomainEntry> RedisDNSCache::find(const std::string& domain) {
-    try {
-        // 查询 Redis 中是否存在指定域名的哈希表
-        redisReply* reply = (redisReply*)redisCommand(getConnection(),
-            "HGETALL dns:entries:%s", domain.c_str());
+    // 每 REDIS_VERDICT_BATCH 条一次 EVALSHA，全部批次先发出（流水线）再统一等待回复
+    std::vector<ScriptArgs> batches;
+    std::vector<std::future<RedisReplyPtr>> pending;
+    for (size_t begin = 0; begin < remote.size(); begin += REDIS_VERDICT_BATCH) {
+        size_t end = std::min(remote.size(), begin + REDIS_VERDICT_BATCH);
+        ScriptArgs args;
+        args.add("3", 1);
+        args.add("dns:lru", 7);
+        args.add(REDIS_EXPIRY_INDEX, std::strlen(REDIS_EXPIRY_INDEX));
+        args.add(REDIS_PENDING_REPORT_SET, std::strlen(REDIS_PENDING_REPORT_SET));
+        for (const auto& arg : head) {
+            args.add(arg);
+        }
+        for (size_t i = begin; i < end; ++i) {
+            args.add(remote[i]->domain);
+            args.add(kDigits[static_cast<int>(remote[i]->status)], 1);
+            args.add(kDigits[static_cast<int>(remote[i]->action)], 1);
+            args.add(hits[i]);
+        }
+        pending.push_back(evalScriptAsync(verdict_script, args));
+        batches.push_back(std::move(args));
+    }
 
-        if (reply == nullptr || reply->type == REDIS_REPLY_ERROR || reply->elements == 0) {
-            freeReplyObject(reply);
-            return nullptr;
+    std::string error;
+    for (size_t b = 0; b < pending.size(); ++b) {
+        RedisReplyPtr reply = awaitScript(verdict_script, batches[b], pending[b]);
+        if (!reply || reply->type != REDIS_REPLY_ARRAY || reply->elements != 2) {
+            error = (reply && reply->str) ? reply->str : "unexpected reply";
+            continue;
         }
 
-        DomainEntry entry;
-        std::map<std::string, std::string> fields;
+        // 先移除脚本删除的域名，再写入新值
+        evictFromL1(reply->element[0]);
+        const redisReply* entries = reply->element[1];
+        for (size_t i = 0; i < entries->elements; ++i) {
+            const redisReply* e = entries->element[i];
+            if (e->type != REDIS_REPLY_ARRAY || e->elements != 5) continue;
+            std::string_view domain(e->element[0]->str, e->element[0]->len);
+            l1.put(domain, DomainL1Cache::Value{
+                static_cast<DomainStatus>(e->element[1]->integer),
+                static_cast<DomainAction>(e->element[2]->integer),
+                static_cast<uint32_t>(e->element[3]->integer),
+                static_cast<time_t>(now), static_cast<time_t>(now),
+                static_cast<int>(e->element[4]->integer)});
+            ++applied;
+        }
+    }
+
+    if (!error.empty()) {
+        throw std::runtime_error("applyVerdicts error: " + error);
+    }
+    return applied;
+}
 
-        // 将所有字段存入 map
-        for (size_t i = 0; i < reply->elements; i += 2) {
-            std::string key(reply->element[i]->str, reply->element[i]->len);
-            std::string value(reply->element[i + 1]->str, reply->element[i + 1]->len);
-            fields[key] = value;
+std::shared_ptr<RedisDNSCache::DomainEntry> RedisDNSCache::find(const std::string& domain) {
+    // 先查 L1 缓存，命中时不访问 Redis
+    DomainL1Cache::Value cached;
+    if (l1.get(domain, std::time(nullptr), cached)) {
+        return std::make_shared<DomainEntry>(DomainEntry{
+            domain, cached.status, cached.action, cached.query_count,
+            cached.last_updated, cached.last_accessed});
+    }
+
+    try {
+        // 按当前编码读取（GET 紧凑值或 HGETALL 哈希）
+        auto pending = requestEntry(domain, encoding.load());
+        DomainL1Cache::Value value;
+        if (!loadEntry(domain, pending, value)) {
+            return nullptr;
         }
-        freeReplyObject(reply);
 
-        // 解析字段构造对象
-        entry.domain = fields["domain"];
-        entry.status = static_cast<DomainStatus>(std::stoi(fields["status"]));
-        entry.action = static_cast<DomainAction>(std::stoi(fields["action"]));
-        entry.query_count = std::stoul(fields["query_count"]);
-        entry.last_updated = std::stoll(fields["last_updated"]);
-        entry.last_accessed = std::stoll(fields["last_accessed"]);
+        // 回填 L1 缓存（已过期或缺少 ttl 的条目不会写入）
+        l1.put(domain, value);
 
-        return std::make_shared<DomainEntry>(entry);
+        return std::make_shared<DomainEntry>(DomainEntry{
+            domain, value.status, value.action, value.query_count,
+            value.last_updated, value.last_accessed});
     } catch (const std::exception& e) {
         std::cerr << "Redis error: " << e.what() << std::endl;
         return nullptr;
@@ -483,6 +1065,8 @@ bool RedisDNSCache::remove(const std::string& domain) {
         lock.unlock();
         executeCommand("DEL dns:entries:%s", domain.c_str());
         executeCommand("ZREM dns:lru %s", domain.c_str());
+        executeCommand("ZREM %s %s", REDIS_EXPIRY_INDEX, domain.c_str());
+        l1.erase(domain);
         
         return true;
     } catch (const std::exception& e) {
@@ -499,7 +1083,7 @@ bool RedisDNSCache::remove(const std::string& domain) {
 size_t RedisDNSCache::size() {
     std::lock_guard<std::mutex> lock(mtx);
     
-    redisReply* reply = (redisReply*)redisCommand(getConnection(), "ZCARD dns:lru");
+    redisReply* reply = redis.command("ZCARD dns:lru");
     if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) {
         freeReplyObject(reply);
         throw std::runtime_error("Failed to get cache size");
@@ -0,0 +1,88 @@
+/**
+ * @file ReportBatchPolicy.cpp
+ * @brief 自适应攒批策略（到达速率的时间衰减 EWMA）与逐批次统计实现。
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "ReportBatchPolicy.h"
+
+namespace {
+
+void update_max(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+double to_ms(uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+} // namespace
+
+ReportBatchPolicy::ReportBatchPolicy(const ReportBatchLimits& limits) : limits_(limits) {
+    limits_.max_domains = std::max<size_t>(limits_.max_domains, 1);
+}
+
+void ReportBatchPolicy::on_arrival(size_t count, Clock::time_point now) {
+    if (count == 0) return;
+
+    double tau = std::chrono::duration<double>(kRateWindow).count();
+    if (last_arrival_ == Clock::time_point{}) {
+        rate_ = count / tau;
+    } else {
+        // 时间衰减 EWMA：间隔 dt 内到达 count 个，权重 1 - e^(-dt/tau)
+        double dt = std::max(std::chrono::duration<double>(now - last_arrival_).count(), 1e-3);
+        double w = std::exp(-dt / tau);
+        rate_ = w * rate_ + (1.0 - w) * (count / dt);
+    }
+    last_arrival_ = now;
+
+    double linger = std::chrono::duration<double>(limits_.max_linger).count();
+    double expected = rate_ * linger;
+    target_ = static_cast<size_t>(std::clamp(expected, 1.0, static_cast<double>(limits_.max_domains)));
+}
+
+bool ReportBatchPolicy::should_send(size_t domains, size_t bytes, Clock::duration waited) const {
+    if (domains == 0) return false;
+    return domains >= target_ || bytes >= limits_.max_bytes || waited >= limits_.max_linger;
+}
+
+void ReportBatchMetrics::record(size_t size, size_t batch_bytes, std::chrono::nanoseconds wait,
+                                std::chrono::nanoseconds rtt, bool ok) {
+    batches.fetch_add(1, std::memory_order_relaxed);
+    if (!ok) failures.fetch_add(1, std::memory_order_relaxed);
+    domains.fetch_add(size, std::memory_order_relaxed);
+    bytes.fetch_add(batch_bytes, std::memory_order_relaxed);
+    update_max(max_size, size);
+
+    if (wait.count() >= 0) {
+        waited_batches.fetch_add(1, std::memory_order_relaxed);
+        wait_ns.fetch_add(static_cast<uint64_t>(wait.count()), std::memory_order_relaxed);
+        update_max(max_wait_ns, static_cast<uint64_t>(wait.count()));
+    }
+
+    uint64_t rtt_count = static_cast<uint64_t>(std::max<int64_t>(rtt.count(), 0));
+    rtt_ns.fetch_add(rtt_count, std::memory_order_relaxed);
+    update_max(max_rtt_ns, rtt_count);
+}
+
+std::string ReportBatchMetrics::summary() const {
+    uint64_t n = batches.load();
+    uint64_t waited = waited_batches.load();
+
+    std::ostringstream out;
+    out << n << " batches (" << failures.load() << " failed), "
+        << domains.load() << " domains, " << bytes.load() << " bytes, "
+        << "avg size " << (n ? static_cast<double>(domains.load()) / n : 0.0)
+        << ", max size " << max_size.load()
+        << ", avg wait " << (waited ? to_ms(wait_ns.load()) / waited : 0.0) << "ms"
+        << ", max wait " << to_ms(max_wait_ns.load()) << "ms"
+        << ", avg rtt " << (n ? to_ms(rtt_ns.load()) / n : 0.0) << "ms"
+        << ", max rtt " << to_ms(max_rtt_ns.load()) << "ms";
+    return out.str();
+}
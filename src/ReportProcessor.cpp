@@ -0,0 +1,239 @@
+/**
+ * @file ReportProcessor.cpp
+ * @brief 域名上报流水线阶段实现：自适应攒批、并发预算、非阻塞指数退避与待上报集合重新同步。
+ */
+
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+#include <unordered_set>
+#include <algorithm>
+
+#include "ReportProcessor.h"
+#include "WorkStealingPool.h"
+#include "pipeline_stats.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 一个上报批次
+struct ReportBatch {
+    std::vector<std::string> domains;
+    size_t bytes = 0;                  // 估算负载字节数
+    size_t attempts = 0;               // 已失败的次数
+    Clock::time_point first_arrival{}; // 第一个域名进入批次的时间（用于等待时间统计）
+};
+
+// 第 attempts 次失败后的退避时间：kRetryDelay * 2^(attempts-1)，不超过 kRetryDelayMax
+Clock::duration backoff_delay(size_t attempts) {
+    Clock::duration delay = kRetryDelay;
+    for (size_t i = 1; i < attempts && delay < kRetryDelayMax; ++i) {
+        delay *= 2;
+    }
+    return std::min<Clock::duration>(delay, kRetryDelayMax);
+}
+
+} // namespace
+
+void report_processor(
+    DomainStore& cache,
+    ReportQueue& report_queue,
+    std::atomic<bool>& stop_reporting,
+    DomainReporter& reporter
+) {
+    std::atomic<size_t> in_flight{0};    // 进行中的上报请求数
+    std::mutex failed_mutex;
+    std::vector<ReportBatch> failed;     // 发送线程写入的失败批次，由主循环取走并调度重试
+    std::vector<ReportBatch> retries;    // 等待退避结束的批次
+    Clock::time_point backoff_until{};   // 退避截止时间，此前不发送任何请求
+
+    ReportBatchPolicy policy(ReportBatchLimits{kReportBatchMax, kReportBatchMaxBytes, kReportLinger});
+    ReportBatchMetrics metrics;
+
+    WorkStealingPool senders(kMaxInFlightReports);
+
+    // 将批次交给发送线程：成功后从待上报集合中移除，失败则交回主循环
+    auto send = [&](ReportBatch&& batch) {
+        in_flight.fetch_add(1);
+        // 只统计首次发送的等待时间，重试批次的等待包含退避
+        auto start = Clock::now();
+        std::chrono::nanoseconds wait = batch.attempts == 0 ? start - batch.first_arrival
+                                                            : std::chrono::nanoseconds(-1);
+        senders.submit([&, wait, batch = std::move(batch)]() mutable {
+            bool ok;
+            auto sent_at = Clock::now();
+            {
+                StageTimer timer(pipeline_stats.report_ns);
+                ok = reporter.reportDomains(cache, batch.domains);
+            }
+            metrics.record(batch.domains.size(), batch.bytes, wait, Clock::now() - sent_at, ok);
+            if (ok) {
+                try {
+                    cache.removePendingReportDomains(batch.domains);
+                } catch (const std::exception& e) {
+                    std::cerr << "[report_processor] error: " << e.what() << std::endl;
+                }
+            } else {
+                ++batch.attempts;
+                std::lock_guard<std::mutex> lock(failed_mutex);
+                failed.push_back(std::move(batch));
+            }
+            in_flight.fetch_sub(1);
+        });
+    };
+
+    // 积压中的域名（current.bytes 为其估算字节数，batch_start 为其中第一个域名的到达时间）
+    ReportBatch current;
+    Clock::time_point batch_start{};
+    auto append = [&](std::string&& domain) {
+        if (current.domains.empty()) batch_start = Clock::now();
+        current.bytes += ReportBatchPolicy::domain_bytes(domain);
+        current.domains.push_back(std::move(domain));
+    };
+
+    // 从积压头部切出一个批次发送：至多 kReportBatchMax 个域名、kReportBatchMaxBytes 字节（至少一个域名）
+    auto send_current = [&]() {
+        ReportBatch batch;
+        batch.first_arrival = batch_start;
+        size_t count = 0;
+        while (count < current.domains.size() && count < kReportBatchMax) {
+            size_t bytes = ReportBatchPolicy::domain_bytes(current.domains[count]);
+            if (count > 0 && batch.bytes + bytes > kReportBatchMaxBytes) break;
+            batch.bytes += bytes;
+            ++count;
+        }
+        if (count == current.domains.size()) {
+            batch.domains.swap(current.domains);
+        } else {
+            auto split = current.domains.begin() + count;
+            batch.domains.assign(std::make_move_iterator(current.domains.begin()),
+                                 std::make_move_iterator(split));
+            current.domains.erase(current.domains.begin(), split);
+        }
+        current.bytes -= batch.bytes;
+        send(std::move(batch));
+    };
+
+    // 与 Redis 待上报集合重新同步：补报因队列满、重试耗尽或上次退出而遗留的域名，
+    // 并移除已经过期的域名
+    auto resync = [&]() {
+        try {
+            std::vector<std::string> expired;
+            std::unordered_set<std::string> queued(current.domains.begin(), current.domains.end());
+            for (auto& domain : cache.getPendingReportDomains()) {
+                if (queued.count(domain)) continue;
+                if (cache.find(domain)) {
+                    append(std::move(domain));
+                } else {
+                    expired.push_back(std::move(domain));
+                }
+            }
+            cache.removePendingReportDomains(expired);
+        } catch (const std::exception& e) {
+            std::cerr << "[report_processor] resync failed: " << e.what() << std::endl;
+        }
+    };
+
+    std::vector<QueryRecord> records;
+    records.reserve(kReportBatchMax);
+    auto last_resync = Clock::now() - kReportResyncInterval;  // 启动时先同步一次
+
+    while (!stop_reporting.load(std::memory_order_acquire)) {
+        auto now = Clock::now();
+
+        // 失败批次：按失败次数计算退避时间，退避期间暂停发送，不阻塞任何线程
+        {
+            std::lock_guard<std::mutex> lock(failed_mutex);
+            for (auto& batch : failed) {
+                if (batch.attempts >= kMaxRetryCount) {
+                    std::cerr << "[report_processor] giving up " << batch.domains.size()
+                              << " domains after " << batch.attempts << " attempts\n";
+                    continue;
+                }
+                backoff_until = std::max(backoff_until, now + backoff_delay(batch.attempts));
+                retries.push_back(std::move(batch));
+            }
+            failed.clear();
+        }
+
+        // 判定服务器正常时，周期性补报待上报集合中的遗留域名
+        if (now - last_resync >= kReportResyncInterval && retries.empty() &&
+            in_flight.load() == 0 && now >= backoff_until) {
+            if (metrics.batches.load() > 0) {
+                std::cout << "[report_processor] " << metrics.summary()
+                          << ", target batch " << policy.target_size()
+                          << " @ " << policy.arrival_rate() << " domains/s\n";
+            }
+            resync();
+            last_resync = now;
+        }
+
+        if (now >= backoff_until) {
+            // 先重试失败批次，再发送新批次，均受并发预算限制
+            while (!retries.empty() && in_flight.load() < kMaxInFlightReports) {
+                send(std::move(retries.back()));
+                retries.pop_back();
+            }
+            while (in_flight.load() < kMaxInFlightReports &&
+                   policy.should_send(current.domains.size(), current.bytes, now - batch_start)) {
+                send_current();
+                batch_start = now;
+            }
+        }
+
+        // 积压过多时暂停取队列（队列满后新域名被丢弃，留待重新同步时补报）
+        if (current.domains.size() >= kReportBatchMax * kMaxInFlightReports) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        // 可发送时取到凑满目标批次为止（空闲时目标为 1，第一个域名到达即返回），最多等到 linger 截止；
+        // 退避中或预算用尽时以短周期轮询，避免空转
+        auto deadline = now + kReportLinger;
+        size_t want = kReportBatchMax;
+        bool can_send = now >= backoff_until && in_flight.load() < kMaxInFlightReports;
+        if (!can_send) {
+            deadline = now + std::chrono::milliseconds(10);
+        } else {
+            size_t target = policy.target_size();
+            want = target > current.domains.size() ? target - current.domains.size() : 1;
+            if (!current.domains.empty()) {
+                deadline = std::min(deadline, batch_start + kReportLinger);
+            }
+        }
+        report_queue.pop_bulk(records, std::min(want, kReportBatchMax), deadline);
+        size_t arrived = 0;
+        for (const auto& record : records) {
+            if (record.empty()) continue;  // 空记录为“唤醒退出”标志
+            append(std::string(record.domain()));
+            ++arrived;
+        }
+        policy.on_arrival(arrived, Clock::now());
+        records.clear();
+    }
+
+    // 退出：取出队列中剩余的域名做最后一次发送（不再重试），并等待进行中的请求完成
+    QueryRecord record;
+    while (report_queue.try_pop(record)) {
+        if (!record.empty()) append(std::string(record.domain()));
+    }
+    while (!current.domains.empty()) {
+        send_current();
+    }
+    while (in_flight.load() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    if (!retries.empty() || !failed.empty()) {
+        std::cerr << "[report_processor] " << retries.size() + failed.size()
+                  << " failed batches left in pending set for next start\n";
+    }
+    if (metrics.batches.load() > 0) {
+        std::cout << "[report_processor] " << metrics.summary() << "\n";
+    }
+    std::cout << "[report_processor] stopped\n";
+}
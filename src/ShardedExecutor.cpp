@@ -0,0 +1,73 @@
+/**
+ * @file ShardedExecutor.cpp
+ * @brief 按键亲和的分片执行器实现
+ */
+
+#include <iostream>
+#include <exception>
+#include <functional>
+
+#include "ShardedExecutor.h"
+
+ShardedExecutor::ShardedExecutor(size_t shard_count) {
+    if (shard_count == 0) shard_count = 1;
+
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards.emplace_back(new Shard);
+    }
+    for (auto& shard : shards) {
+        Shard* s = shard.get();
+        s->worker = std::thread([this, s] { worker_loop(*s); });
+    }
+}
+
+ShardedExecutor::~ShardedExecutor() {
+    stop = true;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->condition.notify_one();
+    }
+    for (auto& shard : shards) {
+        if (shard->worker.joinable()) shard->worker.join();
+    }
+}
+
+size_t ShardedExecutor::shard_for(std::string_view key) const {
+    return std::hash<std::string_view>{}(key) % shards.size();
+}
+
+void ShardedExecutor::submit(size_t shard, Task task) {
+    Shard& s = *shards[shard % shards.size()];
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.tasks.push_back(std::move(task));
+    }
+    s.condition.notify_one();
+}
+
+// 分片线程主循环：一次取走队列中的全部任务，按提交顺序依次执行
+void ShardedExecutor::worker_loop(Shard& shard) {
+    std::deque<Task> local;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            shard.condition.wait(lock, [this, &shard] {
+                return stop.load() || !shard.tasks.empty();
+            });
+
+            // 停止且任务队列空，线程退出
+            if (stop && shard.tasks.empty()) return;
+
+            local.swap(shard.tasks);
+        }
+
+        for (Task& task : local) {
+            try {
+                task();
+            } catch (const std::exception& e) {
+                std::cerr << "[ShardedExecutor] task error: " << e.what() << std::endl;
+            }
+        }
+        local.clear();
+    }
+}
@@ -4,13 +4,13 @@
 #include <condition_variable>
 
 #include "StatsProcessor.h"
-#include "RedisDNSCache.h"
+#include "DomainStore.h"
 
 static std::condition_variable stats_cv;
 static std::mutex stats_mutex;
 
 void stats_processor(
-    RedisDNSCache& cache,
+    DomainStore& cache,
     std::atomic<bool>& stop_processing,
     DomainReporter& reporter,
     int interval_seconds
@@ -0,0 +1,195 @@
+/**
+ * @file Whitelist.cpp
+ * @brief 反向 label 后缀树白名单实现（单张开放寻址边表）与 RCU 式发布。
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "Whitelist.h"
+
+namespace {
+
+constexpr uint8_t kExact = 1;      // 到此节点为止的域名本身在名单中
+constexpr uint8_t kWildcard = 2;   // 此节点及其所有子域名在名单中
+
+uint64_t hash_label(uint32_t parent, std::string_view label) {
+    uint64_t h = 1469598103934665603ULL;  // FNV-1a
+    for (char c : label) {
+        h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+    }
+    // 混入父节点编号后做一次 fmix64，使低位分布均匀（槽位取低位）
+    h ^= static_cast<uint64_t>(parent) * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// 去掉首尾空白、转小写、去掉末尾的 '.'；空行与注释返回空串
+std::string normalize_pattern(std::string_view line) {
+    size_t begin = 0;
+    size_t end = line.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(line[begin]))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(line[end - 1]))) --end;
+    if (begin == end || line[begin] == '#') return std::string();
+
+    std::string pattern(line.substr(begin, end - begin));
+    std::transform(pattern.begin(), pattern.end(), pattern.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (!pattern.empty() && pattern.back() == '.') pattern.pop_back();
+    return pattern;
+}
+
+} // namespace
+
+WhitelistMatcher::WhitelistMatcher() : edges_(16), flags_(1, 0) {}
+
+std::shared_ptr<const WhitelistMatcher> WhitelistMatcher::build(const std::vector<std::string>& patterns) {
+    std::shared_ptr<WhitelistMatcher> matcher(new WhitelistMatcher);
+    for (const auto& line : patterns) {
+        matcher->add(normalize_pattern(line));
+    }
+    return matcher;
+}
+
+std::shared_ptr<const WhitelistMatcher> WhitelistMatcher::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("cannot open whitelist file: " + path);
+    }
+
+    std::shared_ptr<WhitelistMatcher> matcher(new WhitelistMatcher);
+    std::string line;
+    while (std::getline(file, line)) {
+        matcher->add(normalize_pattern(line));
+    }
+    return matcher;
+}
+
+void WhitelistMatcher::add(std::string_view pattern) {
+    bool wildcard = false;
+    if (pattern.size() >= 2 && pattern[0] == '*' && pattern[1] == '.') {
+        wildcard = true;
+        pattern.remove_prefix(2);
+    }
+    if (pattern.empty() || pattern.find('*') != std::string_view::npos) return;  // 只支持前缀通配
+
+    // 从最右侧的 label 开始逐级插入
+    uint32_t node = 0;
+    size_t end = pattern.size();
+    for (;;) {
+        size_t dot = pattern.rfind('.', end - 1);
+        size_t start = (dot == std::string_view::npos) ? 0 : dot + 1;
+        std::string_view label = pattern.substr(start, end - start);
+        if (label.empty()) return;  // 连续的 '.'：非法规则，忽略（已插入的中间节点无标记，不影响匹配）
+
+        node = add_child(node, label);
+        if (start == 0) break;
+        end = start - 1;
+    }
+
+    flags_[node] |= wildcard ? kWildcard : kExact;
+    ++pattern_count_;
+}
+
+uint32_t WhitelistMatcher::find_child(uint32_t parent, std::string_view label, uint64_t hash) const {
+    size_t mask = edges_.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Edge& edge = edges_[i];
+        if (edge.child == kNone) return kNone;
+        if (edge.hash == hash && edge.parent == parent && edge.label_len == label.size() &&
+            labels_.compare(edge.label_offset, edge.label_len, label) == 0) {
+            return edge.child;
+        }
+    }
+}
+
+uint32_t WhitelistMatcher::add_child(uint32_t parent, std::string_view label) {
+    uint64_t hash = hash_label(parent, label);
+    uint32_t child = find_child(parent, label, hash);
+    if (child != kNone) return child;
+
+    // 负载因子不超过 0.75
+    if ((edge_count_ + 1) * 4 > edges_.size() * 3) grow();
+
+    child = static_cast<uint32_t>(flags_.size());
+    flags_.push_back(0);
+
+    Edge edge;
+    edge.hash = hash;
+    edge.parent = parent;
+    edge.child = child;
+    edge.label_offset = static_cast<uint32_t>(labels_.size());
+    edge.label_len = static_cast<uint32_t>(label.size());
+    labels_.append(label.data(), label.size());
+
+    size_t mask = edges_.size() - 1;
+    size_t i = hash & mask;
+    while (edges_[i].child != kNone) i = (i + 1) & mask;
+    edges_[i] = edge;
+    ++edge_count_;
+    return child;
+}
+
+void WhitelistMatcher::grow() {
+    std::vector<Edge> old(edges_.size() * 2);
+    old.swap(edges_);
+    size_t mask = edges_.size() - 1;
+    for (const Edge& edge : old) {
+        if (edge.child == kNone) continue;
+        size_t i = edge.hash & mask;
+        while (edges_[i].child != kNone) i = (i + 1) & mask;
+        edges_[i] = edge;
+    }
+}
+
+bool WhitelistMatcher::matches(std::string_view domain) const {
+    if (!domain.empty() && domain.back() == '.') domain.remove_suffix(1);
+    if (domain.empty()) return false;
+
+    uint32_t node = 0;
+    size_t end = domain.size();
+    for (;;) {
+        size_t dot = domain.rfind('.', end - 1);
+        size_t start = (dot == std::string_view::npos) ? 0 : dot + 1;
+        std::string_view label = domain.substr(start, end - start);
+        if (label.empty()) return false;
+
+        node = find_child(node, label, hash_label(node, label));
+        if (node == kNone) return false;
+        if (flags_[node] & kWildcard) return true;   // *.suffix 覆盖 suffix 本身及所有子域名
+        if (start == 0) return (flags_[node] & kExact) != 0;
+        end = start - 1;
+    }
+}
+
+std::shared_ptr<const WhitelistMatcher> Whitelist::snapshot() const {
+    return std::atomic_load(&current_);
+}
+
+void Whitelist::publish(std::shared_ptr<const WhitelistMatcher> matcher) {
+    std::atomic_store(&current_, std::move(matcher));
+}
+
+bool Whitelist::reload(const std::string& path) {
+    try {
+        auto start = std::chrono::steady_clock::now();
+        auto matcher = WhitelistMatcher::load(path);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "[Whitelist] loaded " << matcher->patterns() << " patterns ("
+                  << matcher->nodes() << " nodes) from " << path << " in "
+                  << elapsed.count() << "s\n";
+        publish(std::move(matcher));
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[Whitelist] reload failed, keeping previous list: " << e.what() << std::endl;
+        return false;
+    }
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <sys/stat.h>
+
+#include "WhitelistWatcher.h"
+
+static std::condition_variable watcher_cv;
+static std::mutex watcher_mutex;
+
+namespace {
+
+struct FileVersion {
+    bool exists = false;
+    time_t mtime = 0;
+    long mtime_nsec = 0;
+    off_t size = 0;
+
+    bool operator==(const FileVersion& other) const {
+        return exists == other.exists && mtime == other.mtime &&
+               mtime_nsec == other.mtime_nsec && size == other.size;
+    }
+};
+
+FileVersion file_version(const std::string& path) {
+    FileVersion version;
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+        version.exists = true;
+        version.mtime = st.st_mtim.tv_sec;
+        version.mtime_nsec = st.st_mtim.tv_nsec;
+        version.size = st.st_size;
+    }
+    return version;
+}
+
+} // namespace
+
+void whitelist_watcher(
+    Whitelist& whitelist,
+    const std::string& path,
+    std::atomic<bool>& stop_processing
+) {
+    FileVersion loaded = file_version(path);
+    uint64_t reloads = 0;
+
+    std::unique_lock<std::mutex> lock(watcher_mutex);
+    while (!stop_processing.load(std::memory_order_acquire)) {
+        if (watcher_cv.wait_for(lock, kWhitelistPollInterval,
+                                [&stop_processing]() { return stop_processing.load(); })) {
+            break;
+        }
+
+        // 文件被删除时保留当前名单，等待重新出现
+        FileVersion current = file_version(path);
+        if (!current.exists || current == loaded) continue;
+
+        // 构建期间不持有任何查询方使用的锁
+        if (whitelist.reload(path)) {
+            ++reloads;
+        }
+        loaded = current;
+    }
+
+    std::cout << "[WhitelistWatcher] Exiting watcher thread, " << reloads << " reloads\n";
+}
+
+void stop_whitelist_watcher() {
+    watcher_cv.notify_all();
+}
@@ -0,0 +1,50 @@
+/**
+ * @file WriteBehindBuffer.cpp
+ * @brief 访问次数写回缓冲区实现（按域名哈希分片累加）
+ */
+
+#include <algorithm>
+#include <functional>
+
+#include "WriteBehindBuffer.h"
+
+WriteBehindBuffer::WriteBehindBuffer(size_t capacity) : capacity(capacity) {
+    for (size_t i = 0; i < WRITE_BEHIND_SHARDS; ++i) {
+        shards.emplace_back(new Shard);
+    }
+}
+
+WriteBehindBuffer::~WriteBehindBuffer() = default;
+
+bool WriteBehindBuffer::add(const std::string& domain, uint32_t hits, time_t now) {
+    Shard& shard = *shards[std::hash<std::string>{}(domain) % shards.size()];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto result = shard.deltas.try_emplace(domain);
+    if (result.second && pending.fetch_add(1, std::memory_order_relaxed) >= capacity) {
+        // 缓冲区已满：不再接纳新域名
+        pending.fetch_sub(1, std::memory_order_relaxed);
+        shard.deltas.erase(result.first);
+        dropped_deltas.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Delta& delta = result.first->second;
+    delta.hits += hits;
+    delta.last_accessed = std::max(delta.last_accessed, now);
+    return true;
+}
+
+void WriteBehindBuffer::drain(std::vector<std::pair<std::string, Delta>>& out) {
+    for (auto& shard : shards) {
+        std::unordered_map<std::string, Delta> taken;
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            taken.swap(shard->deltas);
+            pending.fetch_sub(taken.size(), std::memory_order_relaxed);
+        }
+        for (auto& item : taken) {
+            out.emplace_back(item.first, item.second);
+        }
+    }
+}
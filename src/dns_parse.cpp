@@ -1,123 +1,164 @@
 #include <string>
 #include <vector>
 #include <cstdint>
-#include <optional>
-#include <stdexcept>
 #include <iostream>
 
 #include "dns_parse.h"
+#include "domain_canon.h"
 
-std::optional<std::string> read_domain_name(const std::vector<uint8_t>& packet, size_t& pos, size_t max_len, int jump_limit) {
-    std::string domain;
-    int jumps = 0;
+bool read_domain_name(ByteSpan packet, size_t& pos, char* out, size_t out_cap,
+                      size_t& out_len, int jump_limit) {
+    const uint8_t* data = packet.data;
+    size_t max_len = packet.size;
     size_t curr_pos = pos;
+    size_t end_pos = 0;     // 域名在原位置所占字节之后的位置
+    bool jumped = false;    // 是否已跟随过压缩指针
+    int jumps = 0;
+    size_t len_out = 0;
+
+    while (true) {
+        // 域名未以零长度 label 结束就到达报文末尾
+        if (curr_pos >= max_len) {
+            std::cerr << "[dns_parse]: domain name runs past end of packet, pos=" << curr_pos << "\n";
+            return false;
+        }
 
-    while (curr_pos < max_len && jumps < jump_limit) {
-        uint8_t len = packet[curr_pos];
+        uint8_t len = data[curr_pos];
 
         // 检测是否是压缩指针（以 11 开头的 2 字节）
         if ((len & 0xC0) == 0xC0) {
             if (curr_pos + 1 >= max_len) {
                 std::cerr << "[dns_parse]: pointer overflow, missing second byte of compression pointer\n";
-                return std::nullopt;
+                return false;
             }
 
             // 获取跳转的偏移量
-            size_t offset = ((len & 0x3F) << 8) | packet[curr_pos + 1];
+            size_t offset = ((len & 0x3F) << 8) | data[curr_pos + 1];
             if (offset >= max_len) {
                 std::cerr << "[dns_parse]: pointer offset out of bounds, offset=" << offset << "\n";
-                return std::nullopt;
+                return false;
             }
 
-            // 递归读取跳转位置的域名
-            size_t tmp_pos = offset;
-            auto pointed = read_domain_name(packet, tmp_pos, max_len, jump_limit - 1);
-            if (!pointed.has_value()) {
-                std::cerr << "[dns_parse]: failed to parse domain name at compression pointer target\n";
-                return std::nullopt;
+            // 防止压缩指针死循环
+            if (++jumps >= jump_limit) {
+                std::cerr << "[dns_parse]: exceeded jump limit, possible compression loop\n";
+                return false;
             }
 
-            // 拼接子域名
-            if (!domain.empty() && !pointed->empty())
-                domain += ".";
-            domain += *pointed;
-
-            curr_pos += 2; // 跳过指针两个字节
-            break; // 压缩指针终止后续解析
+            // 第一次跳转前记录返回位置：跳过指针两个字节
+            if (!jumped) {
+                end_pos = curr_pos + 2;
+                jumped = true;
+            }
+            curr_pos = offset;
+            continue;
         }
 
         // 正常结束（零长度 label）
         if (len == 0) {
-            curr_pos++;
+            if (!jumped) end_pos = curr_pos + 1;
             break;
         }
 
         // 长度非法（应小于64）
         if (len > 63) {
             std::cerr << "[dns_parse]: invalid label length, len=" << (int)len << "\n";
-            return std::nullopt;
+            return false;
         }
 
         // 检查是否越界
         if (curr_pos + len >= max_len) {
             std::cerr << "[dns_parse]: label length out of bounds, pos=" << curr_pos << ", len=" << (int)len << "\n";
-            return std::nullopt;
+            return false;
         }
 
-        // 提取当前 label，并拼接成 FQDN 形式
-        if (!domain.empty()) domain += ".";
-        domain += std::string(reinterpret_cast<const char*>(&packet[curr_pos + 1]), len);
+        // 检查输出长度（含分隔点）
+        size_t needed = len_out + (len_out ? 1 : 0) + len;
+        if (needed > DNS_MAX_NAME_LEN || needed > out_cap) {
+            std::cerr << "[dns_parse]: domain name too long, len=" << needed << "\n";
+            return false;
+        }
+
+        // 提取当前 label（同时转小写并校验字符），拼接成 FQDN 形式
+        if (len_out) out[len_out++] = '.';
+        if (!canonicalize_label(&data[curr_pos + 1], len, out + len_out)) {
+            std::cerr << "[dns_parse]: illegal character in label, pos=" << curr_pos << "\n";
+            return false;
+        }
+        len_out += len;
 
         curr_pos += len + 1;
     }
 
-    // 防止压缩指针死循环
-    if (jumps >= jump_limit) {
-        std::cerr << "[dns_parse]: exceeded jump limit, possible compression loop\n";
-        return std::nullopt;
-    }
+    pos = end_pos; // 返回时更新调用者的 pos
+    out_len = len_out;
+    return true;
+}
 
-    pos = curr_pos; // 返回时更新调用者的 pos
-    return domain;
+bool read_dns_header(ByteSpan packet, DnsHeader& header) {
+    if (packet.size < 12) return false;
+    const uint8_t* data = packet.data;
+    header.id = static_cast<uint16_t>((data[0] << 8) | data[1]);
+    header.flags = static_cast<uint16_t>((data[2] << 8) | data[3]);
+    header.qdcount = static_cast<uint16_t>((data[4] << 8) | data[5]);
+    return true;
 }
 
-// 提取 DNS 查询部分中的所有域名
+// 提取 DNS 查询部分中的所有问题记录
 // 参数：packet 是完整的 DNS 数据包
-std::vector<std::string> extract_dns_queries(const std::vector<uint8_t>& packet) {
-    std::vector<std::string> domains;
+size_t extract_dns_questions(ByteSpan packet, DnsNameArena& arena,
+                             DnsQuestion* out, size_t max_out) {
+    const uint8_t* data = packet.data;
 
     // DNS 包头最少需要 12 字节
-    if (packet.size() < 12) {
+    if (packet.size < 12) {
         std::cerr << "[dns_parse]: packet too short, header must be at least 12 bytes\n";
-        return domains;
+        return 0;
     }
 
     // 读取 QDCOUNT（问题数）
-    uint16_t qdcount = (packet[4] << 8) | packet[5];
+    uint16_t qdcount = (data[4] << 8) | data[5];
     if (qdcount == 0) {
         std::cerr << "[dns_parse]: QDCOUNT is zero, no query domain to extract\n";
-        return domains;
+        return 0;
     }
 
+    size_t count = 0;
     size_t pos = 12; // 问题部分从字节 12 开始
-    for (int i = 0; i < qdcount; ++i) {
+    for (int i = 0; i < qdcount && count < max_out; ++i) {
         // 读取第 i 个域名
-        auto domain_opt = read_domain_name(packet, pos, packet.size());
-
-        if (!domain_opt.has_value()) {
+        size_t name_len = 0;
+        if (!read_domain_name(packet, pos, arena.cursor(), arena.remaining(), name_len)) {
             std::cerr << "[dns_parse]: invalid domain name at query index " << i << "\n";
             break;
         }
 
-        domains.push_back(*domain_opt);
-
-        // 跳过 QTYPE (2 bytes) + QCLASS (2 bytes)
-        if (pos + 4 > packet.size()) {
+        // 读取 QTYPE (2 bytes) + QCLASS (2 bytes)
+        if (pos + 4 > packet.size) {
             std::cerr << "[dns_parse]: packet too short to read QTYPE/QCLASS at query index " << i << "\n";
             break;
         }
+
+        DnsQuestion& q = out[count++];
+        q.name = arena.commit(name_len);
+        q.qtype = static_cast<uint16_t>((data[pos] << 8) | data[pos + 1]);
+        q.qclass = static_cast<uint16_t>((data[pos + 2] << 8) | data[pos + 3]);
         pos += 4;
     }
 
+    return count;
+}
+
+std::vector<std::string> extract_dns_queries(const std::vector<uint8_t>& packet) {
+    std::vector<std::string> domains;
+    DnsNameArena arena;
+    DnsQuestion questions[DNS_MAX_QUESTIONS];
+
+    size_t n = extract_dns_questions(ByteSpan{packet.data(), packet.size()}, arena,
+                                     questions, DNS_MAX_QUESTIONS);
+    domains.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        domains.emplace_back(questions[i].name);
+    }
     return domains;
 }
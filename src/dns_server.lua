@@ -1,29 +1,10 @@
 local ngx = require "ngx"
 local cjson = require "cjson"
 
--- 两张表：一个用于精确匹配，一个用于通配后缀匹配
-local exact_domains = {}
-local wildcard_suffixes = {}
+local whitelist = require "whitelist"
 
--- 读取 domain.txt 文件
-local file = io.open("/home/pingyuan/code/dns_parse/src/domain.txt", "r")
-if file then
-    for line in file:lines() do
-        local domain = line:match("^%s*(.-)%s*$")
-        if domain ~= "" then
-            if domain:sub(1, 2) == "*." then
-                -- "*.baidu.com" → 存储为 "baidu.com"
-                table.insert(wildcard_suffixes, domain:sub(3))
-            else
-                exact_domains[domain] = true
-            end
-        end
-    end
-    file:close()
-else
-    ngx.say("[Error] Failed to open domain.txt")
-    ngx.log(ngx.ERR, "[Error] Failed to open domain.txt")
-end
+-- 白名单在 init_by_lua 阶段加载一次（见 whitelist.lua），这里只检查是否需要重新加载
+whitelist.refresh()
 
 -- 设置响应头
 ngx.header.content_type = "text/plain"
@@ -47,20 +28,6 @@ end
 -- ngx.say(post_data)
 -- ngx.say("")
 
--- 检查是否匹配函数
-local function is_domain_matched(domain)
-    if exact_domains[domain] then
-        return true
-    end
-    for _, suffix in ipairs(wildcard_suffixes) do
-        -- 完全匹配或后缀匹配（且前面是点）
-        if domain == suffix or domain:sub(-#suffix - 1) == "." .. suffix then
-            return true
-        end
-    end
-    return false
-end
-
 -- -- 处理域名
 -- local domains = data.domains
 -- if domains and type(domains) == "table" then
@@ -82,7 +49,7 @@ local drop_set = {}
 
 if domains and type(domains) == "table" then
     for _, domain in ipairs(domains) do
-        if is_domain_matched(domain) then
+        if whitelist.matches(domain) then
             permitted_set[domain] = true
         else
             drop_set[domain] = true
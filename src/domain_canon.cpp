@@ -0,0 +1,136 @@
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "domain_canon.h"
+
+namespace {
+
+// 标量查表：合法字节映射为其小写形式，非法字节映射为 0
+struct CanonTable {
+    uint8_t map[256];
+
+    CanonTable() {
+        std::memset(map, 0, sizeof(map));
+        for (int c = 'a'; c <= 'z'; ++c) map[c] = static_cast<uint8_t>(c);
+        for (int c = 'A'; c <= 'Z'; ++c) map[c] = static_cast<uint8_t>(c | 0x20);
+        for (int c = '0'; c <= '9'; ++c) map[c] = static_cast<uint8_t>(c);
+        map[static_cast<uint8_t>('-')] = '-';
+        map[static_cast<uint8_t>('_')] = '_';
+    }
+};
+
+const CanonTable kCanonTable;
+
+[[maybe_unused]] inline bool canonicalize_scalar(const uint8_t* src, size_t len, char* dst) {
+    uint8_t bad = 0;
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t c = kCanonTable.map[src[i]];
+        bad |= static_cast<uint8_t>(c == 0);
+        dst[i] = static_cast<char>(c);
+    }
+    return bad == 0;
+}
+
+#if defined(__SSE2__)
+// 处理 16 字节：返回非法字节掩码为 0 时表示全部合法
+// 非 ASCII 字节按有符号比较为负数，不会落入任何合法区间
+inline __m128i canon_block_sse2(__m128i v, int& valid_mask) {
+    const __m128i upper_lo = _mm_set1_epi8('A' - 1);
+    const __m128i upper_hi = _mm_set1_epi8('Z' + 1);
+    const __m128i lower_lo = _mm_set1_epi8('a' - 1);
+    const __m128i lower_hi = _mm_set1_epi8('z' + 1);
+    const __m128i digit_lo = _mm_set1_epi8('0' - 1);
+    const __m128i digit_hi = _mm_set1_epi8('9' + 1);
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+
+    __m128i is_upper = _mm_and_si128(_mm_cmpgt_epi8(v, upper_lo), _mm_cmplt_epi8(v, upper_hi));
+    __m128i lowered = _mm_or_si128(v, _mm_and_si128(is_upper, case_bit));
+
+    __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lowered, lower_lo), _mm_cmplt_epi8(lowered, lower_hi));
+    __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(v, digit_lo), _mm_cmplt_epi8(v, digit_hi));
+    __m128i is_sym = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('-')),
+                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+
+    valid_mask = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(is_alpha, is_digit), is_sym));
+    return lowered;
+}
+#endif
+
+#if defined(__AVX2__)
+inline __m256i canon_block_avx2(__m256i v, unsigned& valid_mask) {
+    const __m256i upper_lo = _mm256_set1_epi8('A' - 1);
+    const __m256i upper_hi = _mm256_set1_epi8('Z' + 1);
+    const __m256i lower_lo = _mm256_set1_epi8('a' - 1);
+    const __m256i lower_hi = _mm256_set1_epi8('z' + 1);
+    const __m256i digit_lo = _mm256_set1_epi8('0' - 1);
+    const __m256i digit_hi = _mm256_set1_epi8('9' + 1);
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+
+    __m256i is_upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, upper_lo), _mm256_cmpgt_epi8(upper_hi, v));
+    __m256i lowered = _mm256_or_si256(v, _mm256_and_si256(is_upper, case_bit));
+
+    __m256i is_alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lowered, lower_lo), _mm256_cmpgt_epi8(lower_hi, lowered));
+    __m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, digit_lo), _mm256_cmpgt_epi8(digit_hi, v));
+    __m256i is_sym = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')),
+                                     _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+
+    valid_mask = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_or_si256(is_alpha, is_digit), is_sym)));
+    return lowered;
+}
+#endif
+
+} // namespace
+
+bool canonicalize_label(const uint8_t* src, size_t len, char* dst) {
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 32 <= len; i += 32) {
+        unsigned mask;
+        __m256i out = canon_block_avx2(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), mask);
+        if (mask != 0xFFFFFFFFu) return false;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+    }
+#endif
+
+#if defined(__SSE2__)
+    for (; i + 16 <= len; i += 16) {
+        int mask;
+        __m128i out = canon_block_sse2(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), mask);
+        if (mask != 0xFFFF) return false;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+    }
+
+    // 尾部不足 16 字节：拷贝到临时缓冲区处理，避免越过 label 边界读写
+    size_t tail = len - i;
+    if (tail > 0) {
+        alignas(16) uint8_t buf[16];
+        std::memset(buf, 'a', sizeof(buf));
+        std::memcpy(buf, src + i, tail);
+        int mask;
+        __m128i out = canon_block_sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(buf)), mask);
+        if (mask != 0xFFFF) return false;
+        _mm_store_si128(reinterpret_cast<__m128i*>(buf), out);
+        std::memcpy(dst + i, buf, tail);
+    }
+    return true;
+#else
+    return canonicalize_scalar(src + i, len - i, dst + i);
+#endif
+}
+
+const char* canonicalize_impl_name() {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
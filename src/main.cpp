@@ -1,57 +1,379 @@
 #include <iostream>
 #include <thread>
 #include <atomic>
+#include <cctype>
+#include <cerrno>
 #include <csignal>
+#include <cstdint>
 #include <string>
+#include <memory>
+#include <cstdlib>
+#include <getopt.h>
 
 #include "pcap_capture.h"
 #include "RedisDNSCache.h"
+#include "MemoryDomainStore.h"
 #include "CacheProcessor.h"
-#include "ThreadSafeQueue.h"
-#include "ThreadPool.h"
 #include "DomainReporter.h"
+#include "ReportProcessor.h"
 #include "StatsProcessor.h"
+#include "ExpirySweeper.h"
+#include "QueryCountFlusher.h"
+#include "WhitelistWatcher.h"
+#include "pcap_replay.h"
+#include "domain_canon.h"
+#include "pipeline_stats.h"
 
 // 全局变量
 std::atomic<bool> stop_processing(false);
-ThreadSafeQueue<std::string> domain_queue;
+DomainQueue domain_queue(DOMAIN_QUEUE_CAPACITY, OverflowPolicy::DROP_OLDEST);
+
+// 写入空记录唤醒处理线程（只尝试一次，不执行溢出策略）。
+// 队列满时处理线程本就不会空等，写入失败无妨；BLOCK 策略下阻塞写入会在消费者退出后永久卡住
+static void wake_domain_queue() {
+    QueryRecord wake{};
+    domain_queue.try_push(wake);
+}
 
 void signal_handler(int signal) {
     stop_processing = true;
     stop_packet_capture();  // 主动打断 pcap 抓包线程
     stop_stats_report();
-    domain_queue.push("");  // 唤醒处理线程以便退出
+    stop_expiry_sweeper();
+    stop_query_count_flusher();
+    stop_whitelist_watcher();
+    wake_domain_queue();  // 空记录：唤醒处理线程以便退出
+}
+
+static void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options] <network_interface>\n"
+              << "       " << prog << " --replay <file.pcap> [--speed <max|N>]\n"
+              << "Options:\n"
+              << "  -b, --backend <pcap|ring>   capture backend (default: pcap)\n"
+              << "  -t, --capture-threads <N>   N-way PACKET_FANOUT capture, implies ring backend (default: 1)\n"
+              << "  -r, --replay <file>         replay a .pcap/.pcapng file instead of live capture\n"
+              << "  -s, --speed <max|N>         replay speed: max = as fast as possible (default),\n"
+              << "                              1 = original timing, N = N x speed\n"
+              << "  -q, --queue-capacity <N>    domain queue capacity (default: " << DOMAIN_QUEUE_CAPACITY << ")\n"
+              << "  -p, --queue-policy <P>      full-queue policy: block | drop-newest | drop-oldest (default)\n"
+              << "  -e, --executor <E>          cache update executor: sharded (default) | pool\n"
+              << "  -w, --workers <N>           cache shards / pool threads (default: CPU count)\n"
+              << "  -c, --l1-capacity <N>       in-process L1 cache entries, 0 = disabled (default: " << L1_CACHE_CAPACITY << ")\n"
+              << "  -f, --flush-interval <MS>   write-behind query_count flush interval, 0 = write-through (default: "
+              << kQueryCountFlushInterval.count() << ")\n"
+              << "  -E, --encoding <hash|packed> Redis entry encoding for new writes (default: hash)\n"
+              << "  -M, --migrate               convert all existing entries to --encoding, then exit\n"
+              << "  -S, --store <redis|memory>  domain store: redis (default) | memory (in-process, single node)\n"
+              << "  -W, --whitelist <file>      local whitelist (domain or *.suffix per line), matching domains are\n"
+              << "                              marked FULL/PERMIT without a report; reloaded when the file changes\n"
+              << "Example: " << prog << " lo\n"
+              << "         " << prog << " --backend ring eth0\n"
+              << "         " << prog << " --capture-threads 4 eth0\n"
+              << "         " << prog << " --replay dns.pcap --speed 10\n"
+              << "         " << prog << " --encoding packed --migrate\n"
+              << "         " << prog << " --store memory --replay dns.pcap\n"
+              << "         " << prog << " --whitelist whitelist.txt eth0\n";
+}
+
+// 解析非负整数参数：整个字符串必须是十进制数字，拒绝 "4x"、负数与超出范围的值
+static bool parse_count(const char* text, size_t& out) {
+    if (!std::isdigit(static_cast<unsigned char>(text[0]))) return false;
+    errno = 0;
+    char* end = nullptr;
+    unsigned long long n = std::strtoull(text, &end, 10);
+    if (errno == ERANGE || *end != '\0' || n > SIZE_MAX) return false;
+    out = static_cast<size_t>(n);
+    return true;
 }
 
 int main(int argc, char** argv) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <network_interface>\n"
-                  << "Example: " << argv[0] << " lo\n";
+    CaptureBackend backend = CaptureBackend::PCAP;
+    size_t capture_threads = 1;
+    std::string replay_file;
+    double replay_speed = REPLAY_SPEED_MAX;
+    size_t queue_capacity = DOMAIN_QUEUE_CAPACITY;
+    OverflowPolicy queue_policy = OverflowPolicy::DROP_OLDEST;
+    CacheExecutorMode executor_mode = CacheExecutorMode::SHARDED;
+    size_t cache_workers = std::thread::hardware_concurrency();
+    size_t l1_capacity = L1_CACHE_CAPACITY;
+    EntryEncoding encoding = EntryEncoding::HASH;
+    bool migrate = false;
+    StoreBackend store_backend = StoreBackend::REDIS;
+    std::chrono::milliseconds flush_interval = kQueryCountFlushInterval;
+    std::string whitelist_file;
+
+    static const struct option long_options[] = {
+        {"backend",         required_argument, nullptr, 'b'},
+        {"capture-threads", required_argument, nullptr, 't'},
+        {"replay",          required_argument, nullptr, 'r'},
+        {"speed",           required_argument, nullptr, 's'},
+        {"queue-capacity",  required_argument, nullptr, 'q'},
+        {"queue-policy",    required_argument, nullptr, 'p'},
+        {"executor",        required_argument, nullptr, 'e'},
+        {"workers",         required_argument, nullptr, 'w'},
+        {"l1-capacity",     required_argument, nullptr, 'c'},
+        {"flush-interval",  required_argument, nullptr, 'f'},
+        {"encoding",        required_argument, nullptr, 'E'},
+        {"migrate",         no_argument,       nullptr, 'M'},
+        {"store",           required_argument, nullptr, 'S'},
+        {"whitelist",       required_argument, nullptr, 'W'},
+        {"help",            no_argument,       nullptr, 'h'},
+        {nullptr,           0,                 nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "b:t:r:s:q:p:e:w:c:f:E:MS:W:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'b':
+                if (std::string(optarg) == "pcap") {
+                    backend = CaptureBackend::PCAP;
+                } else if (std::string(optarg) == "ring") {
+                    backend = CaptureBackend::TPACKET_V3;
+                } else {
+                    std::cerr << "Unknown capture backend: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 't': {
+                size_t n = 0;
+                if (!parse_count(optarg, n) || n < 1) {
+                    std::cerr << "Invalid capture thread count: " << optarg << "\n";
+                    return 1;
+                }
+                capture_threads = n;
+                break;
+            }
+            case 'r':
+                replay_file = optarg;
+                break;
+            case 's':
+                if (std::string(optarg) == "max") {
+                    replay_speed = REPLAY_SPEED_MAX;
+                } else {
+                    char* end = nullptr;
+                    replay_speed = std::strtod(optarg, &end);
+                    if (end == optarg || *end != '\0' || !(replay_speed > 0)) {
+                        std::cerr << "Invalid replay speed: " << optarg << "\n";
+                        return 1;
+                    }
+                }
+                break;
+            case 'q': {
+                size_t n = 0;
+                if (!parse_count(optarg, n) || n < 2) {
+                    std::cerr << "Invalid queue capacity: " << optarg << "\n";
+                    return 1;
+                }
+                queue_capacity = n;
+                break;
+            }
+            case 'p':
+                if (std::string(optarg) == "block") {
+                    queue_policy = OverflowPolicy::BLOCK;
+                } else if (std::string(optarg) == "drop-newest") {
+                    queue_policy = OverflowPolicy::DROP_NEWEST;
+                } else if (std::string(optarg) == "drop-oldest") {
+                    queue_policy = OverflowPolicy::DROP_OLDEST;
+                } else {
+                    std::cerr << "Unknown queue policy: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'e':
+                if (std::string(optarg) == "sharded") {
+                    executor_mode = CacheExecutorMode::SHARDED;
+                } else if (std::string(optarg) == "pool") {
+                    executor_mode = CacheExecutorMode::POOL;
+                } else {
+                    std::cerr << "Unknown executor: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'w': {
+                size_t n = 0;
+                if (!parse_count(optarg, n) || n < 1) {
+                    std::cerr << "Invalid worker count: " << optarg << "\n";
+                    return 1;
+                }
+                cache_workers = n;
+                break;
+            }
+            case 'c': {
+                size_t n = 0;
+                if (!parse_count(optarg, n)) {
+                    std::cerr << "Invalid L1 cache capacity: " << optarg << "\n";
+                    return 1;
+                }
+                l1_capacity = n;
+                break;
+            }
+            case 'f': {
+                size_t n = 0;
+                if (!parse_count(optarg, n) || n > static_cast<size_t>(INT32_MAX)) {
+                    std::cerr << "Invalid flush interval: " << optarg << "\n";
+                    return 1;
+                }
+                flush_interval = std::chrono::milliseconds(static_cast<long long>(n));
+                break;
+            }
+            case 'E':
+                if (std::string(optarg) == "hash") {
+                    encoding = EntryEncoding::HASH;
+                } else if (std::string(optarg) == "packed") {
+                    encoding = EntryEncoding::PACKED;
+                } else {
+                    std::cerr << "Unknown entry encoding: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'M':
+                migrate = true;
+                break;
+            case 'S':
+                if (std::string(optarg) == "redis") {
+                    store_backend = StoreBackend::REDIS;
+                } else if (std::string(optarg) == "memory") {
+                    store_backend = StoreBackend::MEMORY;
+                } else {
+                    std::cerr << "Unknown store: " << optarg << "\n";
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'W':
+                whitelist_file = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    // 一次性迁移：把 Redis 中的已有条目转换为指定编码后退出，不启动抓包
+    if (migrate) {
+        if (optind != argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        try {
+            RedisDNSCache cache(10, 0);
+            cache.setEntryEncoding(encoding);
+            auto start = std::chrono::steady_clock::now();
+            size_t migrated = cache.migrateEntries(encoding);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            std::cout << "[main] migrated " << migrated << " entries to "
+                      << (encoding == EntryEncoding::PACKED ? "packed" : "hash") << " encoding in "
+                      << elapsed.count() << "s\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Migration failed: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    bool replay_mode = !replay_file.empty();
+    if (replay_mode ? optind != argc : optind != argc - 1) {
+        print_usage(argv[0]);
         return 1;
     }
 
+    // fanout 依赖 AF_PACKET 套接字，多线程抓包时强制使用 ring 后端
+    if (capture_threads > 1 && backend != CaptureBackend::TPACKET_V3) {
+        std::cout << "[main] --capture-threads > 1 requires ring backend, switching to ring\n";
+        backend = CaptureBackend::TPACKET_V3;
+    }
+
     // 设置信号处理
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
 
-    std::string device = argv[1];
+    std::string device = replay_mode ? std::string() : argv[optind];
+
+    // 在任何线程访问队列之前设置容量与溢出策略
+    domain_queue.configure(queue_capacity, queue_policy);
+    std::cout << "[main] domain canonicalization: " << canonicalize_impl_name() << "\n";
+
+    // 回放模式下开启各阶段吞吐统计
+    if (replay_mode) {
+        pipeline_stats.enabled = true;
+    }
 
     try {
         auto& reporter = DomainReporter::getInstance();
         reporter.setServerUrl("http://localhost:8080/hello");
-        // 初始化Redis缓存
-        RedisDNSCache cache(10);
-        
+        // 初始化域名存储：Redis（默认）或进程内存储（单节点部署，无网络往返）
+        bool write_behind = store_backend == StoreBackend::REDIS && flush_interval.count() > 0;
+        std::unique_ptr<DomainStore> store;
+        if (store_backend == StoreBackend::MEMORY) {
+            store.reset(new MemoryDomainStore(10));
+        } else {
+            std::unique_ptr<RedisDNSCache> redis_cache(new RedisDNSCache(10, l1_capacity));
+            redis_cache->setEntryEncoding(encoding);
+            // 访问次数写回：已缓存域名的重复查询只在内存中累加，按周期批量写回 Redis
+            redis_cache->setWriteBehind(write_behind);
+            store = std::move(redis_cache);
+        }
+        DomainStore& cache = *store;
+
+        // 加载本地白名单：命中的域名在缓存阶段直接放行，不再上报
+        Whitelist whitelist;
+        if (!whitelist_file.empty() && !whitelist.reload(whitelist_file)) {
+            return 1;
+        }
+        const Whitelist* local_whitelist = whitelist_file.empty() ? nullptr : &whitelist;
+
+        // 启动上报线程：独立于缓存阶段，判定服务器变慢或宕机时不阻塞缓存更新
+        ReportQueue report_queue(REPORT_QUEUE_CAPACITY, OverflowPolicy::DROP_NEWEST);
+        std::atomic<bool> stop_reporting(false);
+        std::thread report_thread(report_processor, std::ref(cache), std::ref(report_queue),
+                                  std::ref(stop_reporting), std::ref(reporter));
+
         // 启动缓存处理线程
-        ThreadPool pool(std::thread::hardware_concurrency());
-        // ThreadPool pool(1);
         std::thread cache_thread(cache_processor, std::ref(cache),
-                                std::ref(domain_queue), std::ref(stop_processing),
-                                std::ref(reporter), std::ref(pool));
+                                std::ref(domain_queue), std::ref(report_queue),
+                                std::ref(stop_processing), executor_mode, cache_workers,
+                                local_whitelist);
 
         // 启动抓包线程
-        std::thread capture_thread(start_packet_capture, device);
+        std::thread capture_thread;
+        if (replay_mode) {
+            // 回放结束后等待流水线处理完所有域名，打印吞吐报告并退出
+            capture_thread = std::thread([replay_file, replay_speed] {
+                auto start = std::chrono::steady_clock::now();
+                start_pcap_replay(replay_file, replay_speed);
+                if (!wait_pipeline_drained(std::chrono::seconds(60))) {
+                    std::cerr << "[main] timed out waiting for pipeline to drain\n";
+                }
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                print_pipeline_report(elapsed.count());
+                signal_handler(SIGTERM);
+            });
+        } else if (capture_threads > 1) {
+            capture_thread = std::thread(start_fanout_capture, device, capture_threads);
+        } else {
+            capture_thread = std::thread(start_packet_capture, device, backend);
+        }
         
+        // 启动过期清理线程：按过期索引增量删除到期条目
+        std::thread sweeper_thread(expiry_sweeper, std::ref(cache), std::ref(stop_processing));
+
+        std::thread flusher_thread;
+        if (write_behind) {
+            flusher_thread = std::thread(query_count_flusher, std::ref(cache),
+                                         std::ref(stop_processing), flush_interval);
+        }
+
+        // 名单文件变化时在后台重建并原子替换，不阻塞缓存阶段
+        std::thread whitelist_thread;
+        if (local_whitelist) {
+            whitelist_thread = std::thread(whitelist_watcher, std::ref(whitelist), whitelist_file,
+                                           std::ref(stop_processing));
+        }
+
         std::thread stats_thread(stats_processor, std::ref(cache), std::ref(stop_processing), std::ref(reporter), 60); // 每 60 秒上报
 
         while (!stop_processing.load()) {
@@ -59,10 +381,37 @@ int main(int argc, char** argv) {
         }
         
         // 等待处理线程结束
-        domain_queue.push("");  // 确保处理线程能退出
+        // 先关闭队列：处理线程收到 stop 后不再消费，BLOCK 策略下的生产者立即返回，不会永久阻塞
+        domain_queue.close();
+        wake_domain_queue();  // 确保处理线程能退出
         cache_thread.join();
+
+        // 缓存阶段退出后再停止上报阶段，使其发送最后一批新域名
+        stop_reporting = true;
+        report_queue.push(QueryRecord{});
+        report_thread.join();
         capture_thread.join();
-        // stats_thread.join();
+        stats_thread.join();
+        sweeper_thread.join();
+        if (flusher_thread.joinable()) flusher_thread.join();
+        if (whitelist_thread.joinable()) whitelist_thread.join();
+
+        if (domain_queue.dropped() > 0) {
+            std::cout << "[main] domain_queue dropped " << domain_queue.dropped()
+                      << " records (capacity " << domain_queue.capacity() << ")\n";
+        }
+        L1CacheStats l1 = cache.l1Stats();
+        if (l1.capacity > 0) {
+            uint64_t lookups = l1.hits + l1.misses;
+            std::cout << "[main] L1 cache: " << l1.hits << " hits, " << l1.misses << " misses ("
+                      << (lookups ? 100.0 * l1.hits / lookups : 0.0) << "% hit rate), "
+                      << l1.evictions << " evictions, " << l1.expirations << " expirations, "
+                      << l1.size << "/" << l1.capacity << " entries\n";
+        }
+        if (report_queue.dropped() > 0) {
+            std::cout << "[main] report_queue dropped " << report_queue.dropped()
+                      << " domains, left in pending set for resync\n";
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -3,6 +3,9 @@
 #include <vector>
 #include <cstring>
 #include <memory>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
 #include <netinet/ip.h>
 #include <netinet/ip6.h>
 #include <netinet/udp.h>
@@ -11,31 +14,77 @@
 
 #include "dns_parse.h"
 #include "pcap_capture.h"
+#include "ring_capture.h"
+#include "pipeline_stats.h"
 
 static pcap_t* global_handle = nullptr;
 
-std::vector<std::string> parse_dns_packet(const u_char* packet, uint32_t ip_header_len, uint32_t captured_len) {
-    std::vector<std::string> domains;
+// 抓包统计累加值（由抓包线程写入，其他线程读取）
+static std::atomic<uint64_t> stats_received(0);
+static std::atomic<uint64_t> stats_dropped(0);
+static std::atomic<uint64_t> stats_if_dropped(0);
+static std::atomic<uint64_t> stats_freeze(0);
+
+void accumulate_capture_stats(const CaptureStats& delta) {
+    stats_received.fetch_add(delta.packets_received, std::memory_order_relaxed);
+    stats_dropped.fetch_add(delta.packets_dropped, std::memory_order_relaxed);
+    stats_if_dropped.fetch_add(delta.if_dropped, std::memory_order_relaxed);
+    stats_freeze.fetch_add(delta.freeze_count, std::memory_order_relaxed);
+}
+
+CaptureStats get_capture_stats() {
+    CaptureStats st;
+    st.packets_received = stats_received.load(std::memory_order_relaxed);
+    st.packets_dropped = stats_dropped.load(std::memory_order_relaxed);
+    st.if_dropped = stats_if_dropped.load(std::memory_order_relaxed);
+    st.freeze_count = stats_freeze.load(std::memory_order_relaxed);
+    return st;
+}
+
+// pcap_stats 返回的是累计值（32 位，可能回绕），这里换算成增量后累加
+static void collect_pcap_stats(pcap_t* handle, struct pcap_stat& last) {
+    struct pcap_stat ps;
+    if (pcap_stats(handle, &ps) != 0) return;
+
+    CaptureStats delta;
+    delta.packets_received = static_cast<u_int>(ps.ps_recv - last.ps_recv);
+    delta.packets_dropped = static_cast<u_int>(ps.ps_drop - last.ps_drop);
+    delta.if_dropped = static_cast<u_int>(ps.ps_ifdrop - last.ps_ifdrop);
+    accumulate_capture_stats(delta);
+    last = ps;
+}
+
+static void print_capture_stats() {
+    CaptureStats st = get_capture_stats();
+    std::cout << "[dns_capture] kernel stats: received=" << st.packets_received
+              << ", dropped=" << st.packets_dropped
+              << ", if_dropped=" << st.if_dropped
+              << ", freeze=" << st.freeze_count << "\n";
+}
 
-    if (captured_len < ETHERNET_HEADER_LEN + ip_header_len + sizeof(struct udphdr)) return domains;
+// 在抓包缓冲区上原地解析 DNS 问题部分，域名写入 arena，不拷贝 UDP 负载
+size_t parse_dns_packet(const u_char* packet, uint32_t ip_header_len, uint32_t captured_len,
+                        DnsHeader& dns_header, DnsNameArena& arena,
+                        DnsQuestion* questions, size_t max_questions) {
+    if (captured_len < ETHERNET_HEADER_LEN + ip_header_len + sizeof(struct udphdr)) return 0;
 
     const struct udphdr* udp_header = reinterpret_cast<const struct udphdr*>(packet + ETHERNET_HEADER_LEN + ip_header_len);
     uint16_t udp_len = ntohs(udp_header->uh_ulen);
-    if (udp_len < 8) return domains;
+    if (udp_len < 8) return 0;
 
     uint32_t udp_payload_offset = ETHERNET_HEADER_LEN + ip_header_len + sizeof(struct udphdr);
     uint32_t udp_payload_len = captured_len > udp_payload_offset ? captured_len - udp_payload_offset : 0;
 
-    if ((udp_len - 8) > udp_payload_len) return domains;
-
-    const uint8_t* dns_data = packet + udp_payload_offset;
     uint32_t dns_len = udp_len - 8;
-    std::vector<uint8_t> dns_packet(dns_data, dns_data + dns_len);
+    if (dns_len > udp_payload_len) return 0;
 
-    return extract_dns_queries(dns_packet);
+    ByteSpan dns_packet{packet + udp_payload_offset, dns_len};
+    if (!read_dns_header(dns_packet, dns_header)) return 0;
+    return extract_dns_questions(dns_packet, arena, questions, max_questions);
 }
 
 void packet_handler(u_char* user, const struct pcap_pkthdr* header, const u_char* packet) {
+    auto* batch = reinterpret_cast<std::vector<QueryRecord>*>(user);
     try {
         if (header->caplen < ETHERNET_HEADER_LEN + sizeof(struct ip)) return;
 
@@ -46,12 +95,38 @@ void packet_handler(u_char* user, const struct pcap_pkthdr* header, const u_char
         uint32_t ip_header_len = ip_header->ip_hl << 2;
         const struct udphdr* udp_header = reinterpret_cast<const struct udphdr*>(packet + ETHERNET_HEADER_LEN + ip_header_len);
 
-        if (ntohs(udp_header->uh_sport) != DNS_PORT && ntohs(udp_header->uh_dport) != DNS_PORT) return;
-
-        std::vector<std::string> domains = parse_dns_packet(packet, ip_header_len, header->caplen);
-        for (const auto& domain : domains) {
-            if (!domain.empty()) {
-                domain_queue.push(domain);
+        bool to_server = ntohs(udp_header->uh_dport) == DNS_PORT;
+        if (ntohs(udp_header->uh_sport) != DNS_PORT && !to_server) return;
+
+        // 每个抓包线程复用自己的域名缓冲区，解析过程不产生堆分配
+        thread_local DnsNameArena arena;
+        thread_local DnsQuestion questions[DNS_MAX_QUESTIONS];
+        arena.clear();
+
+        DnsHeader dns_header;
+        size_t count = parse_dns_packet(packet, ip_header_len, header->caplen,
+                                        dns_header, arena, questions, DNS_MAX_QUESTIONS);
+        if (count == 0) return;
+
+        // 公共字段：客户端为非 53 端口一侧
+        QueryRecord record;
+        std::memset(record.client_ip, 0, sizeof(record.client_ip));
+        const struct in_addr& client = to_server ? ip_header->ip_src : ip_header->ip_dst;
+        std::memcpy(record.client_ip, &client, sizeof(client));
+        record.ip_version = 4;
+        record.txid = dns_header.id;
+        record.ts_usec = static_cast<int64_t>(header->ts.tv_sec) * 1000000 + header->ts.tv_usec;
+
+        for (size_t i = 0; i < count; ++i) {
+            const std::string_view& domain = questions[i].name;
+            if (domain.empty()) continue;
+            record.set_domain(domain);
+            record.qtype = questions[i].qtype;
+            pipeline_count(pipeline_stats.domains_queued);
+            if (batch) {
+                batch->push_back(record);
+            } else {
+                domain_queue.push(record);
                 // std::cout << "[dns_capture] domain: " << domain << "\n";
             }
         }
@@ -60,7 +135,13 @@ void packet_handler(u_char* user, const struct pcap_pkthdr* header, const u_char
     }
 }
 
-void start_packet_capture(const std::string& dev) {
+void start_packet_capture(const std::string& dev, CaptureBackend backend) {
+    if (backend == CaptureBackend::TPACKET_V3) {
+        start_ring_capture(dev);
+        print_capture_stats();
+        return;
+    }
+
     char errbuf[PCAP_ERRBUF_SIZE];
     global_handle = pcap_open_live(dev.c_str(), 65535, 1, 1000, errbuf);
     if (!global_handle) {
@@ -88,6 +169,10 @@ void start_packet_capture(const std::string& dev) {
 
     std::cout << "[dns_capture] start capturing on: " << dev << "\n";
 
+    struct pcap_stat last_stats;
+    std::memset(&last_stats, 0, sizeof(last_stats));
+    auto last_stats_time = std::chrono::steady_clock::now();
+
     while (!stop_processing.load(std::memory_order_acquire)) {
         struct pcap_pkthdr* header;
         const u_char* packet;
@@ -99,14 +184,49 @@ void start_packet_capture(const std::string& dev) {
             std::cerr << "[dns_capture] error reading packet: " << pcap_geterr(global_handle) << "\n";
             break;
         }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_stats_time >= std::chrono::seconds(1)) {
+            collect_pcap_stats(global_handle, last_stats);
+            last_stats_time = now;
+        }
     }
 
+    collect_pcap_stats(global_handle, last_stats);
+    print_capture_stats();
+
     pcap_freecode(&fp);
     pcap_close(global_handle);
     global_handle = nullptr;
     std::cout << "[dns_capture] packet capture stopped\n";
 }
 
+void start_fanout_capture(const std::string& dev, size_t thread_count) {
+    if (thread_count == 0) thread_count = 1;
+
+    // 同一进程内的所有抓包线程共用一个 fanout 组号
+    int fanout_group = static_cast<int>(getpid() & 0xffff);
+
+    // 所有成员建立成功后才开始抓包；任一成员失败时整体放弃，而不是以缩小的 fanout 宽度静默运行
+    FanoutStartup startup(thread_count);
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back(start_ring_capture, dev, fanout_group, &startup);
+    }
+    for (auto& t : threads) {
+        if (t.joinable()) t.join();
+    }
+
+    if (startup.failures() > 0) {
+        std::cerr << "[dns_capture] fanout capture aborted: " << startup.failures() << " of "
+                  << thread_count << " capture threads failed to start\n";
+        return;
+    }
+
+    print_capture_stats();
+}
+
 void stop_packet_capture() {
     if (global_handle) {
         pcap_breakloop(global_handle);
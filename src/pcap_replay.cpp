@@ -0,0 +1,78 @@
+#include <pcap.h>
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+#include "pcap_replay.h"
+#include "pcap_capture.h"
+#include "pipeline_stats.h"
+
+bool start_pcap_replay(const std::string& file, double speed) {
+    char errbuf[PCAP_ERRBUF_SIZE];
+    pcap_t* handle = pcap_open_offline(file.c_str(), errbuf);
+    if (!handle) {
+        std::cerr << "[pcap_replay] pcap_open_offline failed: " << errbuf << "\n";
+        return false;
+    }
+
+    // packet_handler 按以太网帧解析，其他链路层类型（如 Linux cooked）无法直接处理
+    if (pcap_datalink(handle) != DLT_EN10MB) {
+        std::cerr << "[pcap_replay] unsupported link type " << pcap_datalink(handle)
+                  << ", only Ethernet captures can be replayed\n";
+        pcap_close(handle);
+        return false;
+    }
+
+    std::cout << "[pcap_replay] replaying " << file << " at ";
+    if (speed <= REPLAY_SPEED_MAX) {
+        std::cout << "max speed\n";
+    } else {
+        std::cout << speed << "x\n";
+    }
+
+    using Clock = std::chrono::steady_clock;
+    bool first = true;
+    double first_ts = 0;
+    Clock::time_point replay_start;
+    bool ok = true;
+
+    while (!stop_processing.load(std::memory_order_acquire)) {
+        struct pcap_pkthdr* header;
+        const u_char* packet;
+        int res;
+        {
+            StageTimer timer(pipeline_stats.capture_ns);
+            res = pcap_next_ex(handle, &header, &packet);
+        }
+
+        if (res == PCAP_ERROR_BREAK) break;  // 文件读取完毕
+        if (res == -1) {
+            std::cerr << "[pcap_replay] error reading packet: " << pcap_geterr(handle) << "\n";
+            ok = false;
+            break;
+        }
+        if (res != 1) continue;
+
+        // 按报文时间戳限速：第 i 个报文的发送时刻 = 起点 + (ts_i - ts_0) / speed
+        if (speed > REPLAY_SPEED_MAX) {
+            double ts = header->ts.tv_sec + header->ts.tv_usec / 1e6;
+            if (first) {
+                first_ts = ts;
+                replay_start = Clock::now();
+                first = false;
+            } else if (ts > first_ts) {
+                auto offset = std::chrono::duration<double>((ts - first_ts) / speed);
+                std::this_thread::sleep_until(
+                    replay_start + std::chrono::duration_cast<Clock::duration>(offset));
+            }
+        }
+
+        pipeline_count(pipeline_stats.packets);
+        StageTimer timer(pipeline_stats.parse_ns);
+        packet_handler(nullptr, header, packet);
+    }
+
+    pcap_close(handle);
+    std::cout << "[pcap_replay] replay finished\n";
+    return ok;
+}
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+
+#include "pipeline_stats.h"
+
+PipelineStats pipeline_stats;
+
+bool wait_pipeline_drained(std::chrono::seconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (pipeline_stats.domains_done.load() < pipeline_stats.domains_queued.load()) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+void print_pipeline_report(double elapsed_sec) {
+    uint64_t packets = pipeline_stats.packets.load();
+    uint64_t queued = pipeline_stats.domains_queued.load();
+    uint64_t done = pipeline_stats.domains_done.load();
+    if (elapsed_sec <= 0) elapsed_sec = 1e-9;
+
+    auto print_stage = [](const char* name, uint64_t total_ns, uint64_t count) {
+        std::cout << "  " << std::left << std::setw(10) << name
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(3)
+                  << total_ns / 1e6 << " ms total";
+        if (count > 0) {
+            std::cout << std::setw(12) << std::setprecision(0)
+                      << static_cast<double>(total_ns) / count << " ns/item";
+        }
+        std::cout << "\n";
+    };
+
+    std::cout << "\n=== Pipeline Throughput Report ===\n"
+              << std::fixed << std::setprecision(3)
+              << "  elapsed:   " << elapsed_sec << " s\n"
+              << "  packets:   " << packets << " (" << std::setprecision(0) << packets / elapsed_sec << " pkt/s)\n"
+              << "  domains:   " << queued << " queued, " << done << " processed ("
+              << done / elapsed_sec << " domains/s)\n"
+              << "Per-stage time:\n";
+    print_stage("capture", pipeline_stats.capture_ns.load(), packets);
+    print_stage("parse", pipeline_stats.parse_ns.load(), packets);
+    print_stage("cache", pipeline_stats.cache_ns.load(), done);
+    print_stage("report", pipeline_stats.report_ns.load(), 0);
+    std::cout << "==================================\n\n";
+}
@@ -0,0 +1,261 @@
+/**
+ * @file ring_capture.cpp
+ * @brief TPACKET_V3 环形缓冲区抓包后端实现
+ */
+
+#include <pcap.h>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <unistd.h>
+#include <poll.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#include <linux/filter.h>
+
+#include "ring_capture.h"
+#include "pcap_capture.h"
+
+namespace {
+
+// 使用 libpcap 将过滤表达式编译为经典 BPF，并挂载到 AF_PACKET 套接字上
+bool attach_dns_filter(int fd) {
+    pcap_t* dead = pcap_open_dead(DLT_EN10MB, 65535);
+    if (!dead) {
+        std::cerr << "[ring_capture] pcap_open_dead failed\n";
+        return false;
+    }
+
+    struct bpf_program fp;
+    const char filter_exp[] = "udp and port 53";
+    if (pcap_compile(dead, &fp, filter_exp, 0, PCAP_NETMASK_UNKNOWN) == -1) {
+        std::cerr << "[ring_capture] pcap_compile failed: " << pcap_geterr(dead) << "\n";
+        pcap_close(dead);
+        return false;
+    }
+
+    struct sock_fprog prog;
+    prog.len = static_cast<unsigned short>(fp.bf_len);
+    prog.filter = reinterpret_cast<struct sock_filter*>(fp.bf_insns);
+
+    bool ok = setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) == 0;
+    if (!ok) {
+        std::cerr << "[ring_capture] SO_ATTACH_FILTER failed: " << std::strerror(errno) << "\n";
+    }
+
+    pcap_freecode(&fp);
+    pcap_close(dead);
+    return ok;
+}
+
+// 读取内核统计（读取后内核计数器清零），累加到全局抓包统计
+void collect_ring_stats(int fd) {
+    struct tpacket_stats_v3 st;
+    socklen_t len = sizeof(st);
+    if (getsockopt(fd, SOL_PACKET, PACKET_STATISTICS, &st, &len) != 0) return;
+
+    CaptureStats delta;
+    delta.packets_received = st.tp_packets;
+    delta.packets_dropped = st.tp_drops;
+    delta.freeze_count = st.tp_freeze_q_cnt;
+    accumulate_capture_stats(delta);
+}
+
+// 原地遍历一个已就绪块内的全部帧，逐帧交给 packet_handler，查询记录暂存于 batch
+void walk_block(struct tpacket_block_desc* block, std::vector<QueryRecord>& batch) {
+    uint32_t num_pkts = block->hdr.bh1.num_pkts;
+    auto* ppd = reinterpret_cast<struct tpacket3_hdr*>(
+        reinterpret_cast<uint8_t*>(block) + block->hdr.bh1.offset_to_first_pkt);
+
+    for (uint32_t i = 0; i < num_pkts; ++i) {
+        struct pcap_pkthdr header;
+        header.ts.tv_sec = ppd->tp_sec;
+        header.ts.tv_usec = ppd->tp_nsec / 1000;
+        header.caplen = ppd->tp_snaplen;
+        header.len = ppd->tp_len;
+
+        const u_char* frame = reinterpret_cast<const u_char*>(ppd) + ppd->tp_mac;
+        packet_handler(reinterpret_cast<u_char*>(&batch), &header, frame);
+
+        ppd = reinterpret_cast<struct tpacket3_hdr*>(
+            reinterpret_cast<uint8_t*>(ppd) + ppd->tp_next_offset);
+    }
+}
+
+// 已建立的环形缓冲区
+struct Ring {
+    int fd = -1;
+    void* map = MAP_FAILED;
+    size_t size = 0;
+    struct tpacket_req3 req;
+
+    void release() {
+        if (map != MAP_FAILED) munmap(map, size);
+        if (fd >= 0) close(fd);
+        map = MAP_FAILED;
+        fd = -1;
+    }
+};
+
+// 建立 AF_PACKET 套接字与 TPACKET_V3 环形缓冲区，绑定网卡并（可选）加入 fanout 组；失败时释放已建立的资源
+bool open_ring(const std::string& dev, int fanout_group, Ring& ring) {
+    ring.fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (ring.fd < 0) {
+        std::cerr << "[ring_capture] socket(AF_PACKET) failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    int fd = ring.fd;
+
+    int version = TPACKET_V3;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0) {
+        std::cerr << "[ring_capture] PACKET_VERSION failed: " << std::strerror(errno) << "\n";
+        ring.release();
+        return false;
+    }
+
+    // 先挂载过滤器再绑定网卡，避免绑定后到挂载前的无关报文进入环形缓冲区
+    if (!attach_dns_filter(fd)) {
+        ring.release();
+        return false;
+    }
+
+    struct tpacket_req3& req = ring.req;
+    std::memset(&req, 0, sizeof(req));
+    req.tp_block_size = RING_BLOCK_SIZE;
+    req.tp_block_nr = RING_BLOCK_COUNT;
+    req.tp_frame_size = RING_FRAME_SIZE;
+    req.tp_frame_nr = (RING_BLOCK_SIZE * RING_BLOCK_COUNT) / RING_FRAME_SIZE;
+    req.tp_retire_blk_tov = RING_BLOCK_TIMEOUT_MS;
+    req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+
+    if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) != 0) {
+        std::cerr << "[ring_capture] PACKET_RX_RING failed: " << std::strerror(errno) << "\n";
+        ring.release();
+        return false;
+    }
+
+    ring.size = static_cast<size_t>(req.tp_block_size) * req.tp_block_nr;
+    ring.map = mmap(nullptr, ring.size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (ring.map == MAP_FAILED) {
+        std::cerr << "[ring_capture] mmap failed: " << std::strerror(errno) << "\n";
+        ring.release();
+        return false;
+    }
+
+    struct sockaddr_ll addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    addr.sll_ifindex = static_cast<int>(if_nametoindex(dev.c_str()));
+    if (addr.sll_ifindex == 0 || bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "[ring_capture] bind to " << dev << " failed: " << std::strerror(errno) << "\n";
+        ring.release();
+        return false;
+    }
+
+    // 与 pcap_open_live 保持一致，开启混杂模式
+    struct packet_mreq mreq;
+    std::memset(&mreq, 0, sizeof(mreq));
+    mreq.mr_ifindex = addr.sll_ifindex;
+    mreq.mr_type = PACKET_MR_PROMISC;
+    if (setsockopt(fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+        std::cerr << "[ring_capture] PACKET_MR_PROMISC failed: " << std::strerror(errno) << "\n";
+    }
+
+    // 加入 fanout 组：按流哈希分发，同一流的报文始终落在同一线程；DEFRAG 保证分片报文先重组
+    if (fanout_group >= 0) {
+        int fanout_arg = (fanout_group & 0xffff) |
+                         ((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16);
+        if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &fanout_arg, sizeof(fanout_arg)) != 0) {
+            std::cerr << "[ring_capture] PACKET_FANOUT failed: " << std::strerror(errno) << "\n";
+            ring.release();
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool FanoutStartup::arrive(bool ok) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!ok) ++failed;
+    if (pending > 0 && --pending == 0) {
+        cv.notify_all();
+    } else {
+        cv.wait(lock, [this] { return pending == 0; });
+    }
+    return failed == 0;
+}
+
+size_t FanoutStartup::failures() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+void start_ring_capture(const std::string& dev, int fanout_group, FanoutStartup* startup) {
+    Ring ring;
+    bool ok = open_ring(dev, fanout_group, ring);
+
+    // fanout 模式下等待所有成员建立完毕，任一成员失败则全部放弃
+    if (startup && !startup->arrive(ok)) {
+        if (ok) {
+            std::cerr << "[ring_capture] another fanout member failed to start, closing this ring\n";
+            ring.release();
+        }
+        return;
+    }
+    if (!ok) return;
+
+    int fd = ring.fd;
+    const struct tpacket_req3& req = ring.req;
+
+    std::cout << "[ring_capture] start capturing on: " << dev
+              << " (TPACKET_V3, " << req.tp_block_nr << " x " << (req.tp_block_size >> 10) << " KiB blocks";
+    if (fanout_group >= 0) std::cout << ", fanout group " << fanout_group;
+    std::cout << ")\n";
+
+    uint8_t* base = static_cast<uint8_t*>(ring.map);
+    std::vector<QueryRecord> batch;  // 本线程的块内查询记录缓存，整块处理后一次性入队
+    uint32_t block_idx = 0;
+    auto last_stats = std::chrono::steady_clock::now();
+
+    while (!stop_processing.load(std::memory_order_acquire)) {
+        auto* block = reinterpret_cast<struct tpacket_block_desc*>(
+            base + static_cast<size_t>(block_idx) * req.tp_block_size);
+
+        if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLIN | POLLERR;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, RING_POLL_TIMEOUT_MS) < 0 && errno != EINTR) {
+                std::cerr << "[ring_capture] poll failed: " << std::strerror(errno) << "\n";
+                break;
+            }
+        } else {
+            walk_block(block, batch);
+            // 整块处理完毕后归还内核
+            __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+            block_idx = (block_idx + 1) % req.tp_block_nr;
+            domain_queue.push_bulk(batch);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_stats >= std::chrono::seconds(1)) {
+            collect_ring_stats(fd);
+            last_stats = now;
+        }
+    }
+
+    collect_ring_stats(fd);
+    ring.release();
+    std::cout << "[ring_capture] packet capture stopped\n";
+}
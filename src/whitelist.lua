@@ -0,0 +1,141 @@
+-- 白名单模块：每个 worker 只在启动及名单版本变化时加载一次 domain.txt，
+-- 按 label 建立哈希索引，匹配代价只与域名的 label 数有关，与名单规模无关。
+--
+-- 规则格式（每行一条，# 开头为注释）：
+--   example.com    精确匹配 example.com
+--   *.example.com  匹配 example.com 本身及其任意子域名
+--
+-- 重新加载：/reload 在共享字典中递增名单版本号，各 worker 在处理下一个请求前发现版本变化并重新加载，
+-- 新表构建完成后才替换，加载失败时保留原名单。
+
+local ngx = require "ngx"
+
+local _M = {}
+
+local VERSION_KEY = "whitelist_version"
+
+local path = nil            -- 名单文件路径，由 init 设置
+local exact_domains = {}    -- 精确匹配：域名 → true
+local wildcard_suffixes = {} -- 通配后缀：后缀 → true（"*.baidu.com" 存为 "baidu.com"）
+local pattern_count = 0
+local loaded_version = 0
+
+local function state()
+    return ngx.shared.whitelist_state
+end
+
+-- 读取名单文件并构建新表，失败时返回 nil 和错误信息
+local function build(file_path)
+    local file, err = io.open(file_path, "r")
+    if not file then
+        return nil, "failed to open " .. file_path .. ": " .. tostring(err)
+    end
+
+    local exact, wildcard, count = {}, {}, 0
+    for line in file:lines() do
+        local domain = line:match("^%s*(.-)%s*$"):lower()
+        if domain ~= "" and domain:byte(1) ~= 35 then  -- 35 = '#'
+            if domain:byte(-1) == 46 then              -- 46 = '.'，去掉末尾的点
+                domain = domain:sub(1, -2)
+            end
+            if domain:sub(1, 2) == "*." then
+                if #domain > 2 then
+                    wildcard[domain:sub(3)] = true
+                    count = count + 1
+                end
+            elseif domain ~= "" then
+                exact[domain] = true
+                count = count + 1
+            end
+        end
+    end
+    file:close()
+
+    return { exact = exact, wildcard = wildcard, count = count }
+end
+
+-- 在当前 worker 中加载名单，成功后整体替换
+local function load(version)
+    local list, err = build(path)
+    if not list then
+        ngx.log(ngx.ERR, "[whitelist] reload failed, keeping previous list: ", err)
+        return nil, err
+    end
+
+    exact_domains = list.exact
+    wildcard_suffixes = list.wildcard
+    pattern_count = list.count
+    loaded_version = version
+    ngx.log(ngx.INFO, "[whitelist] loaded ", pattern_count, " patterns from ", path,
+            " (version ", version, ", pid ", ngx.worker.pid(), ")")
+    return pattern_count
+end
+
+-- init_by_lua 阶段调用：在 master 中加载一次，fork 出的 worker 直接继承
+function _M.init(file_path)
+    path = file_path
+    local list, err = build(path)
+    if not list then
+        ngx.log(ngx.ERR, "[whitelist] ", err)
+        return
+    end
+    exact_domains = list.exact
+    wildcard_suffixes = list.wildcard
+    pattern_count = list.count
+    loaded_version = state():get(VERSION_KEY) or 0
+end
+
+-- 每个请求处理前调用：名单版本变化时在本 worker 中重新加载
+function _M.refresh()
+    local version = state():get(VERSION_KEY) or 0
+    if version ~= loaded_version then
+        -- 失败时也记录版本号，避免每个请求都重试；修复文件后再次调用 /reload 即可
+        if not load(version) then
+            loaded_version = version
+        end
+    end
+end
+
+-- 判断域名是否在白名单中：精确匹配一次查表，通配规则按 label 从长到短逐个后缀查表
+function _M.matches(domain)
+    if exact_domains[domain] then
+        return true
+    end
+
+    local suffix = domain
+    local start = 1
+    while true do
+        if wildcard_suffixes[suffix] then
+            return true
+        end
+        local dot = domain:find(".", start, true)
+        if not dot then
+            return false
+        end
+        start = dot + 1
+        suffix = domain:sub(start)
+    end
+end
+
+function _M.count()
+    return pattern_count
+end
+
+-- /reload 处理函数：递增名单版本号并立即在本 worker 中重新加载，其余 worker 在下一个请求时加载
+function _M.handle_reload()
+    local cjson = require "cjson"
+    ngx.header.content_type = "application/json"
+
+    local version = state():incr(VERSION_KEY, 1, 0)
+    local count, err = load(version)
+    if not count then
+        ngx.status = ngx.HTTP_INTERNAL_SERVER_ERROR
+        ngx.say(cjson.encode({ error = err, version = version }))
+        return ngx.exit(ngx.HTTP_INTERNAL_SERVER_ERROR)
+    end
+
+    ngx.say(cjson.encode({ patterns = count, version = version }))
+    return ngx.exit(ngx.HTTP_OK)
+end
+
+return _M